@@ -0,0 +1,87 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Every global allocation and deallocation function is replaced, as a matched set on top of `malloc` and `free`, to count allocations
+// They live in their own translation unit so that they are never inlined into callers, where the compiler would otherwise see `free`
+// called on pointers returned by an opaque `operator new`
+
+#include <new>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "Allocations.hpp"
+
+namespace
+{
+	std::atomic<std::size_t> allocationCount{0};
+
+	inline void* allocate(std::size_t mSize) noexcept
+	{
+		++allocationCount;
+		return std::malloc(mSize == 0 ? 1 : mSize);
+	}
+	inline void* allocateOrThrow(std::size_t mSize)
+	{
+		if(void* p = allocate(mSize)) return p;
+		throw std::bad_alloc{};
+	}
+
+#ifdef __cpp_aligned_new
+	// Over-aligned blocks are carved out of a larger `malloc` block, whose address is stored right before the aligned one
+	inline void* allocateAligned(std::size_t mSize, std::align_val_t mAlignment) noexcept
+	{
+		const auto alignment(static_cast<std::uintptr_t>(mAlignment));
+		++allocationCount;
+
+		auto* base(static_cast<char*>(std::malloc(mSize + alignment + sizeof(void*))));
+		if(base == nullptr) return nullptr;
+
+		auto* result(reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(base) + sizeof(void*) + alignment - 1) & ~(alignment - 1)));
+		std::memcpy(result - sizeof(void*), &base, sizeof(void*));
+		return result;
+	}
+	inline void* allocateAlignedOrThrow(std::size_t mSize, std::align_val_t mAlignment)
+	{
+		if(void* p = allocateAligned(mSize, mAlignment)) return p;
+		throw std::bad_alloc{};
+	}
+	inline void deallocateAligned(void* mPtr) noexcept
+	{
+		if(mPtr == nullptr) return;
+
+		void* base;
+		std::memcpy(&base, static_cast<char*>(mPtr) - sizeof(void*), sizeof(void*));
+		std::free(base);
+	}
+#endif
+}
+
+std::size_t ssvsc::Benchmarks::getAllocationCount() noexcept { return allocationCount.load(); }
+
+void* operator new(std::size_t mSize)										{ return allocateOrThrow(mSize); }
+void* operator new[](std::size_t mSize)										{ return allocateOrThrow(mSize); }
+void* operator new(std::size_t mSize, const std::nothrow_t&) noexcept		{ return allocate(mSize); }
+void* operator new[](std::size_t mSize, const std::nothrow_t&) noexcept	{ return allocate(mSize); }
+
+void operator delete(void* mPtr) noexcept									{ std::free(mPtr); }
+void operator delete[](void* mPtr) noexcept									{ std::free(mPtr); }
+void operator delete(void* mPtr, std::size_t) noexcept						{ std::free(mPtr); }
+void operator delete[](void* mPtr, std::size_t) noexcept					{ std::free(mPtr); }
+void operator delete(void* mPtr, const std::nothrow_t&) noexcept			{ std::free(mPtr); }
+void operator delete[](void* mPtr, const std::nothrow_t&) noexcept			{ std::free(mPtr); }
+
+#ifdef __cpp_aligned_new
+void* operator new(std::size_t mSize, std::align_val_t mAlignment)										{ return allocateAlignedOrThrow(mSize, mAlignment); }
+void* operator new[](std::size_t mSize, std::align_val_t mAlignment)									{ return allocateAlignedOrThrow(mSize, mAlignment); }
+void* operator new(std::size_t mSize, std::align_val_t mAlignment, const std::nothrow_t&) noexcept		{ return allocateAligned(mSize, mAlignment); }
+void* operator new[](std::size_t mSize, std::align_val_t mAlignment, const std::nothrow_t&) noexcept	{ return allocateAligned(mSize, mAlignment); }
+
+void operator delete(void* mPtr, std::align_val_t) noexcept							{ deallocateAligned(mPtr); }
+void operator delete[](void* mPtr, std::align_val_t) noexcept						{ deallocateAligned(mPtr); }
+void operator delete(void* mPtr, std::size_t, std::align_val_t) noexcept			{ deallocateAligned(mPtr); }
+void operator delete[](void* mPtr, std::size_t, std::align_val_t) noexcept			{ deallocateAligned(mPtr); }
+void operator delete(void* mPtr, std::align_val_t, const std::nothrow_t&) noexcept	{ deallocateAligned(mPtr); }
+void operator delete[](void* mPtr, std::align_val_t, const std::nothrow_t&) noexcept	{ deallocateAligned(mPtr); }
+#endif
@@ -0,0 +1,19 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_BENCHMARKS_ALLOCATIONS
+#define SSVSC_BENCHMARKS_ALLOCATIONS
+
+#include <cstddef>
+
+namespace ssvsc
+{
+	namespace Benchmarks
+	{
+		// Number of calls to any global allocation function since the start of the program (see Allocations.cpp)
+		std::size_t getAllocationCount() noexcept;
+	}
+}
+
+#endif
@@ -0,0 +1,386 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Headless benchmark suite: builds seeded scenes in `World<Grid, Retro>` and `World<HashGrid, Impulse>` (and a streamed one in `World<ChunkedGrid, Retro>`)
+// and reports per-frame statistics
+// Usage: SSVSCollisionBenchmarks [--frames N] [--seed N] [--sizes 1000,10000,...] [--scene name]
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "Allocations.hpp"
+
+namespace ssvsc
+{
+	namespace Benchmarks
+	{
+		using Rng = std::mt19937;
+		using Clock = std::chrono::high_resolution_clock;
+
+		// World extent and cell size are derived from the scene and its body count, so that density stays the same at every size
+		struct SceneInfo { const char* name; int halfExtent, cellSize; };
+
+		template<typename TW> struct SceneState
+		{
+			// Level files are mapped at page boundaries: in-memory levels are copied to over-allocated storage, at its first aligned byte
+			std::vector<Body<TW>*> dynamics;
+			std::vector<char> levelData;
+			UPtr<StaticLevel> level;
+			SizeT raysPerFrame{0};
+			bool gravity{false};
+		};
+
+		inline int getRandom(Rng& mRng, int mMin, int mMax) { return std::uniform_int_distribution<int>{mMin, mMax}(mRng); }
+		inline float getRandom(Rng& mRng, float mMin, float mMax) { return std::uniform_real_distribution<float>{mMin, mMax}(mRng); }
+		inline int getSide(SizeT mCount, int mSpacing) { return static_cast<int>(std::sqrt(static_cast<float>(mCount))) * mSpacing; }
+
+		template<typename TW> inline Body<TW>& createBody(TW& mWorld, const Vec2i& mPos, const Vec2i& mSize, bool mStatic)
+		{
+			auto& b(mWorld.create(mPos, mSize, mStatic));
+			b.addGroups(0);
+			if(!mStatic) b.addGroupsToCheck(0);
+			return b;
+		}
+
+		// Fast bodies spread evenly, moving in random directions
+		template<typename TW> inline void setupUniformSwarm(TW& mWorld, SceneState<TW>& mState, Rng& mRng, SizeT mCount, int mHalfSide)
+		{
+			for(auto i(0u); i < mCount; ++i)
+			{
+				auto& b(createBody(mWorld, {getRandom(mRng, -mHalfSide, mHalfSide), getRandom(mRng, -mHalfSide, mHalfSide)}, {getRandom(mRng, 8, 24), getRandom(mRng, 8, 24)}, false));
+				b.setVelocity({getRandom(mRng, -4.f, 4.f), getRandom(mRng, -4.f, 4.f)});
+				mState.dynamics.emplace_back(&b);
+			}
+		}
+
+		// Bodies packed in a narrow column falling on a static floor
+		template<typename TW> inline void setupDensePile(TW& mWorld, SceneState<TW>& mState, Rng& mRng, SizeT mCount, int mHalfSide)
+		{
+			createBody(mWorld, {0, mHalfSide}, {mHalfSide * 2, 64}, true);
+			createBody(mWorld, {-mHalfSide, 0}, {64, mHalfSide * 2}, true);
+			createBody(mWorld, {mHalfSide, 0}, {64, mHalfSide * 2}, true);
+
+			for(auto i(0u); i < mCount; ++i)
+			{
+				auto& b(createBody(mWorld, {getRandom(mRng, -mHalfSide + 64, mHalfSide - 64), getRandom(mRng, -mHalfSide, mHalfSide - 64)}, {16, 16}, false));
+				mState.dynamics.emplace_back(&b);
+			}
+
+			mState.gravity = true;
+		}
+
+		// Few, slow bodies scattered over a huge area
+		template<typename TW> inline void setupSparseOpenWorld(TW& mWorld, SceneState<TW>& mState, Rng& mRng, SizeT mCount, int mHalfSide)
+		{
+			for(auto i(0u); i < mCount; ++i)
+			{
+				auto& b(createBody(mWorld, {getRandom(mRng, -mHalfSide, mHalfSide), getRandom(mRng, -mHalfSide, mHalfSide)}, {32, 32}, false));
+				b.setVelocity({getRandom(mRng, -1.f, 1.f), getRandom(mRng, -1.f, 1.f)});
+				mState.dynamics.emplace_back(&b);
+			}
+		}
+
+		// A tiled level (90% static tiles) with a few dynamic bodies falling through it
+		template<typename TW> inline void setupStaticHeavy(TW& mWorld, SceneState<TW>& mState, Rng& mRng, SizeT mCount, int mHalfSide)
+		{
+			const auto staticCount(mCount - mCount / 10);
+			for(auto i(0u); i < staticCount; ++i)
+			{
+				const int x{getRandom(mRng, -mHalfSide, mHalfSide) / 32 * 32}, y{getRandom(mRng, -mHalfSide, mHalfSide) / 32 * 32};
+				createBody(mWorld, {x, y}, {32, 32}, true);
+			}
+
+			for(auto i(staticCount); i < mCount; ++i)
+			{
+				auto& b(createBody(mWorld, {getRandom(mRng, -mHalfSide, mHalfSide), getRandom(mRng, -mHalfSide, mHalfSide)}, {12, 20}, false));
+				b.setVelocity({getRandom(mRng, -2.f, 2.f), 0.f});
+				mState.dynamics.emplace_back(&b);
+			}
+
+			mState.gravity = true;
+		}
+
+		// The static-heavy level, baked into a `StaticLevel` instead of being made of static bodies
+		template<typename TW> inline void setupStaticLevel(TW& mWorld, SceneState<TW>& mState, Rng& mRng, SizeT mCount, int mHalfSide)
+		{
+			GroupBitset groups;
+			groups.set(0);
+
+			std::vector<StaticLevelBody> statics;
+			for(auto i(0u); i < mCount - mCount / 10; ++i)
+			{
+				const int x{getRandom(mRng, -mHalfSide, mHalfSide) / 32 * 32}, y{getRandom(mRng, -mHalfSide, mHalfSide) / 32 * 32};
+				statics.push_back({AABB{Vec2i{x, y}, Vec2i{16, 16}}, groups, {}});
+			}
+
+			const auto& grid(mWorld.getSpatial());
+			std::vector<char> data;
+			StaticLevel::bake(data, grid.getColumns(), grid.getRows(), grid.getCellSize(), grid.getOffset(), statics);
+
+			mState.levelData.resize(data.size() + Impl::staticLevelAlignment);
+			const auto address(reinterpret_cast<std::uintptr_t>(mState.levelData.data()));
+			char* const aligned{mState.levelData.data() + (Impl::alignStaticLevelOffset(address) - address)};
+			std::memcpy(aligned, data.data(), data.size());
+			mState.level = ssvu::makeUPtr<StaticLevel>(aligned, data.size());
+			mWorld.setStaticLevel(mState.level.get());
+
+			for(auto i(statics.size()); i < mCount; ++i)
+			{
+				auto& b(createBody(mWorld, {getRandom(mRng, -mHalfSide, mHalfSide), getRandom(mRng, -mHalfSide, mHalfSide)}, {12, 20}, false));
+				b.setVelocity({getRandom(mRng, -2.f, 2.f), 0.f});
+				mState.dynamics.emplace_back(&b);
+			}
+
+			mState.gravity = true;
+		}
+
+		// The static-heavy level, queried by many raycasts every frame
+		template<typename TW> inline void setupRaycastHeavy(TW& mWorld, SceneState<TW>& mState, Rng& mRng, SizeT mCount, int mHalfSide)
+		{
+			setupStaticHeavy(mWorld, mState, mRng, mCount, mHalfSide);
+			mState.raysPerFrame = std::min<SizeT>(mCount / 10, 5000);
+		}
+
+		enum class SceneType{UniformSwarm, DensePile, SparseOpenWorld, StaticHeavy, StaticLevel, RaycastHeavy};
+		constexpr SceneType allScenes[]{SceneType::UniformSwarm, SceneType::DensePile, SceneType::SparseOpenWorld, SceneType::StaticHeavy, SceneType::StaticLevel, SceneType::RaycastHeavy};
+
+		inline SceneInfo getSceneInfo(SceneType mType, SizeT mCount)
+		{
+			switch(mType)
+			{
+				case SceneType::UniformSwarm:		return {"uniform-swarm", getSide(mCount, 48) / 2, 64};
+				case SceneType::DensePile:			return {"dense-pile", getSide(mCount, 20) / 2, 32};
+				case SceneType::SparseOpenWorld:	return {"sparse-open-world", getSide(mCount, 400) / 2, 256};
+				case SceneType::StaticHeavy:		return {"static-heavy", getSide(mCount, 40) / 2, 64};
+				case SceneType::StaticLevel:		return {"static-level", getSide(mCount, 40) / 2, 64};
+				case SceneType::RaycastHeavy:		return {"raycast-heavy", getSide(mCount, 40) / 2, 64};
+			}
+
+			return {"", 0, 0};
+		}
+
+		template<typename TW> inline void setupScene(SceneType mType, TW& mWorld, SceneState<TW>& mState, Rng& mRng, SizeT mCount, int mHalfSide)
+		{
+			switch(mType)
+			{
+				case SceneType::UniformSwarm:		setupUniformSwarm(mWorld, mState, mRng, mCount, mHalfSide); break;
+				case SceneType::DensePile:			setupDensePile(mWorld, mState, mRng, mCount, mHalfSide); break;
+				case SceneType::SparseOpenWorld:	setupSparseOpenWorld(mWorld, mState, mRng, mCount, mHalfSide); break;
+				case SceneType::StaticHeavy:		setupStaticHeavy(mWorld, mState, mRng, mCount, mHalfSide); break;
+				case SceneType::StaticLevel:		setupStaticLevel(mWorld, mState, mRng, mCount, mHalfSide); break;
+				case SceneType::RaycastHeavy:		setupRaycastHeavy(mWorld, mState, mRng, mCount, mHalfSide); break;
+			}
+		}
+
+		// Counted outside of the timed section: candidate pairs are the bodies found in the cells spanned by every moving body
+		template<typename TW> inline void countGridWork(TW& mWorld, const SceneState<TW>& mState, SizeT& mPairs, SizeT& mCells)
+		{
+			auto& grid(mWorld.getSpatial());
+
+			for(const auto& b : mState.dynamics)
+			{
+				if(b->isAsleep()) continue;
+
+				const auto& s(b->getShape());
+				const int startX{grid.getIdx(s.getLeft())}, startY{grid.getIdx(s.getTop())}, endX{grid.getIdx(s.getRight())}, endY{grid.getIdx(s.getBottom())};
+				if(!grid.isIdxValid(startX, startY, endX, endY)) continue;
+
+				for(int iX{startX}; iX <= endX; ++iX)
+					for(int iY{startY}; iY <= endY; ++iY)
+					{
+						mPairs += grid.getCell(iX, iY).getBodyCount() + grid.getCell(iX, iY).getStaticCount();
+						++mCells;
+					}
+			}
+		}
+
+		struct Options
+		{
+			SizeT frames{120};
+			unsigned int seed{1337};
+			std::vector<SizeT> sizes{1000, 10000, 100000};
+			std::string scene;
+		};
+
+		inline double getPercentile(std::vector<double>& mValues, double mPercentile)
+		{
+			const auto idx(static_cast<SizeT>(mPercentile * (mValues.size() - 1)));
+			std::nth_element(std::begin(mValues), std::begin(mValues) + idx, std::end(mValues));
+			return mValues[idx];
+		}
+
+		template<template<typename> class TS, template<typename> class TR> inline void run(const char* mWorldName, SceneType mType, SizeT mCount, const Options& mOptions)
+		{
+			using WorldType = World<TS, TR>;
+
+			const auto info(getSceneInfo(mType, mCount));
+			const int halfCells{info.halfExtent / info.cellSize + 4};
+
+			Rng rng{mOptions.seed};
+			WorldType world{halfCells * 2, halfCells * 2, info.cellSize, halfCells};
+			SceneState<WorldType> state;
+			setupScene(mType, world, state, rng, mCount, info.halfExtent);
+
+			std::vector<double> frameTimes;
+			SizeT pairs{0}, cells{0}, allocations{0};
+
+			for(auto f(0u); f < mOptions.frames; ++f)
+			{
+				const auto allocationsBefore(getAllocationCount());
+				const auto start(Clock::now());
+
+				if(state.gravity) for(const auto& b : state.dynamics) if(!b->isAsleep()) b->applyAccel({0.f, 0.5f});
+				world.update(1.f);
+
+				for(auto i(0u); i < state.raysPerFrame; ++i)
+				{
+					const Vec2i origin{getRandom(rng, -info.halfExtent, info.halfExtent), getRandom(rng, -info.halfExtent, info.halfExtent)};
+					const Vec2f dir{getRandom(rng, -1.f, 1.f), getRandom(rng, -1.f, 1.f)};
+					auto query(world.template getQuery<QueryType::RayCast>(origin, dir));
+					query.next();
+				}
+
+				frameTimes.emplace_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+				allocations += getAllocationCount() - allocationsBefore;
+
+				countGridWork(world, state, pairs, cells);
+			}
+
+			std::printf("%-18s %-22s %9zu %9.3f %9.3f %9.3f %9.3f %12zu %10zu %8zu\n", info.name, mWorldName, mCount,
+				getPercentile(frameTimes, 0.5), getPercentile(frameTimes, 0.9), getPercentile(frameTimes, 0.99), getPercentile(frameTimes, 1.0),
+				pairs / mOptions.frames, cells / mOptions.frames, allocations / mOptions.frames);
+		}
+
+		// An open world 10 times as wide as the sparse one, on a chunked grid: only the chunks around a point of interest crossing it from
+		// side to side stay loaded, the others being frozen by a `ChunkStreamer` (streaming is part of the timed section)
+		inline void runStreamed(SizeT mCount, const Options& mOptions)
+		{
+			using WorldType = World<ChunkedGrid, Retro>;
+
+			const int halfExtent{getSide(mCount, 4000) / 2};
+			Rng rng{mOptions.seed};
+			WorldType world{256, 8};
+			SceneState<WorldType> state;
+			setupSparseOpenWorld(world, state, rng, mCount, halfExtent);
+
+			ChunkStreamer<WorldType> streamer{world, 2, 3};
+			std::vector<double> frameTimes;
+			SizeT pairs{0}, cells{0}, allocations{0}, pages{0};
+
+			for(auto f(0u); f < mOptions.frames; ++f)
+			{
+				const auto allocationsBefore(getAllocationCount());
+				const auto start(Clock::now());
+
+				const Vec2i point{-halfExtent + static_cast<int>(2.0 * halfExtent * f / mOptions.frames), 0};
+				streamer.update({point});
+				world.update(1.f);
+
+				frameTimes.emplace_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+				allocations += getAllocationCount() - allocationsBefore;
+				pages += world.getSpatial().getPageCount();
+
+				// Frozen bodies are destroyed: the loaded ones are gathered again
+				state.dynamics.clear();
+				for(const auto& b : world.getBodies()) state.dynamics.emplace_back(b.get());
+				countGridWork(world, state, pairs, cells);
+			}
+
+			std::printf("%-18s %-22s %9zu %9.3f %9.3f %9.3f %9.3f %12zu %10zu %8zu  (%zu pages)\n", "streamed-world", "World<ChunkedGrid, Retro>", mCount,
+				getPercentile(frameTimes, 0.5), getPercentile(frameTimes, 0.9), getPercentile(frameTimes, 0.99), getPercentile(frameTimes, 1.0),
+				pairs / mOptions.frames, cells / mOptions.frames, allocations / mOptions.frames, pages / mOptions.frames);
+		}
+
+		// Parses the decimal number at the start of `mText` into `mOut` and moves `mText` past it; the number must be followed by the end of the string or by one of `mSeparators`
+		inline bool parseNumber(const char*& mText, const char* mSeparators, unsigned long& mOut)
+		{
+			char* end;
+			errno = 0;
+			mOut = std::strtoul(mText, &end, 10);
+			if(*mText < '0' || *mText > '9' || errno == ERANGE || (*end != '\0' && std::strchr(mSeparators, *end) == nullptr)) return false;
+
+			mText = end;
+			return true;
+		}
+		inline std::runtime_error getInvalidValueError(const char* mOption, const char* mValue) { return std::runtime_error{std::string{"invalid value for "} + mOption + ": " + mValue}; }
+
+		inline Options parseOptions(int mArgc, char* mArgv[])
+		{
+			Options result;
+
+			for(int i{1}; i < mArgc; i += 2)
+			{
+				const char* option{mArgv[i]};
+				if(i + 1 == mArgc) throw std::runtime_error{std::string{"missing value for "} + option};
+				const char* value{mArgv[i + 1]};
+
+				unsigned long number;
+				const char* s{value};
+
+				if(std::strcmp(option, "--frames") == 0)
+				{
+					if(!parseNumber(s, "", number) || number == 0) throw getInvalidValueError(option, value);
+					result.frames = number;
+				}
+				else if(std::strcmp(option, "--seed") == 0)
+				{
+					if(!parseNumber(s, "", number) || number > ssvu::NumLimits<unsigned int>::max()) throw getInvalidValueError(option, value);
+					result.seed = number;
+				}
+				else if(std::strcmp(option, "--scene") == 0) result.scene = value;
+				else if(std::strcmp(option, "--sizes") == 0)
+				{
+					result.sizes.clear();
+					while(*s != '\0')
+					{
+						if(!parseNumber(s, ",", number) || (*s == ',' && *++s == '\0')) throw getInvalidValueError(option, value);
+						result.sizes.emplace_back(number);
+					}
+					if(result.sizes.empty()) throw getInvalidValueError(option, value);
+				}
+				else throw std::runtime_error{std::string{"unknown option "} + option};
+			}
+
+			return result;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	using namespace ssvsc;
+	using namespace ssvsc::Benchmarks;
+
+	Options options;
+	try { options = parseOptions(argc, argv); }
+	catch(const std::runtime_error& mError)
+	{
+		std::fprintf(stderr, "%s\nUsage: %s [--frames N] [--seed N] [--sizes 1000,10000,...] [--scene name]\n", mError.what(), argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::printf("%-18s %-22s %9s %9s %9s %9s %9s %12s %10s %8s\n", "scene", "world", "bodies", "p50 ms", "p90 ms", "p99 ms", "max ms", "pairs/frame", "cells/frame", "allocs");
+
+	for(const auto& type : allScenes)
+	{
+		for(const auto& size : options.sizes)
+		{
+			if(!options.scene.empty() && options.scene != getSceneInfo(type, size).name) continue;
+
+			run<Grid, Retro>("World<Grid, Retro>", type, size, options);
+			run<HashGrid, Impulse>("World<HashGrid, Impulse>", type, size, options);
+		}
+	}
+
+	for(const auto& size : options.sizes) if(options.scene.empty() || options.scene == "streamed-world") runStreamed(size, options);
+
+	return 0;
+}
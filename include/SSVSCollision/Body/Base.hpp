@@ -26,6 +26,12 @@ namespace ssvsc
 
 			inline Base(TW& mWorld) noexcept : world(mWorld), spatialInfo{world.spatial, *this} { }
 
+			inline void dispatchDetection(Body<TW>& mBody, FT mFT)
+			{
+				if(world.isDeferringEvents()) world.getEventBuffer().push(Impl::EventType::Detection, *this, &mBody);
+				else onDetection({mBody, mBody.getUserData(), mFT});
+			}
+
 		public:
 			using Groupable::Groupable;
 
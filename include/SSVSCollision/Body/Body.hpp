@@ -7,6 +7,7 @@
 
 #include "SSVSCollision/Body/CallbackInfo.hpp"
 #include "SSVSCollision/Body/BodyData.hpp"
+#include "SSVSCollision/Body/BodyStore.hpp"
 #include "SSVSCollision/Body/Groupable.hpp"
 #include "SSVSCollision/Body/Base.hpp"
 
@@ -20,57 +21,325 @@ namespace ssvsc
 			using ResolverType = typename TW::ResolverType;
 			using ResolverInfoType = typename TW::ResolverInfoType;
 			using ResolutionInfoType = typename TW::ResolutionInfoType;
+			using ContactInfoType = typename TW::ContactInfoType;
 
 			friend TW;
 			friend SpatialInfoType;
 			friend ResolverType;
 			friend ResolverInfoType;
+			friend Impl::ContactCache<TW>;
 
 		protected:
-			BodyData data;
-			std::vector<Body*> toResolve;
+			BodyHandle handle;
+			std::vector<Body*> toResolve, detected, restingContacts;
 			void* userData{nullptr};
-			bool mustInit{true};
+			SizeT pairFrame{0}, restFrames{0}, stepFrame{0};
+			std::uint32_t levelId{0};
+			bool mustInit{true}, destroyed{false};
 
-			inline void integrate(FT mFT) noexcept
+			inline auto& getStore() noexcept				{ return this->world.bodyStore; }
+			inline const auto& getStore() const noexcept	{ return this->world.bodyStore; }
+			inline SizeT getStoreIdx() const noexcept		{ return getStore().getIdx(handle); }
+
+			// Pair lists are reset lazily, the first time the body is involved in a pair during a frame
+			inline void refreshPairs() noexcept
 			{
-				data.velocity += getAcceleration() * mFT;
-				getShape().move(Vec2i(getVelocity() * mFT));
-				ssvs::nullify(data.acceleration);
+				if(pairFrame == this->world.frame) return;
+
+				pairFrame = this->world.frame;
+				toResolve.clear();
+				detected.clear();
 			}
 
-			inline void update(FT mFT)
+			// While resting, bodies are linked (both ways) to the non-static bodies they touch, so that they can be woken when those start moving
+			inline void linkRestingContact(Body& mBody)
+			{
+				if(ssvu::contains(restingContacts, &mBody)) return;
+
+				restingContacts.emplace_back(&mBody);
+				mBody.restingContacts.emplace_back(this);
+			}
+			inline void releaseRestingContacts()
+			{
+				if(restingContacts.empty()) return;
+
+				auto contacts(std::move(restingContacts));
+				restingContacts.clear();
+				for(const auto& b : contacts) ssvu::eraseRemove(b->restingContacts, this);
+				for(const auto& b : contacts) b->wake();
+			}
+			inline void updateSleep()
+			{
+				const auto& settings(this->world.sleepSettings);
+				if(!settings.enabled) return;
+
+				const auto& vel(getVelocity());
+				const auto& res(getLastResolution());
+
+				if(vel.x * vel.x + vel.y * vel.y > settings.velocityThreshold * settings.velocityThreshold
+					|| std::abs(res.x) > settings.resolutionThreshold || std::abs(res.y) > settings.resolutionThreshold)
+				{
+					restFrames = 0;
+					releaseRestingContacts();
+					return;
+				}
+
+				// Resting bodies usually only overlap their supports every few frames, so contacts are gathered over the whole resting period
+				for(const auto& b : detected) if(!b->isStatic()) linkRestingContact(*b);
+				if(++restFrames < settings.frames) return;
+
+				getStore().setFlag(getStoreIdx(), BodyFlag::Asleep, true);
+				ssvs::nullify(getStore().velocities[getStoreIdx()]);
+			}
+			inline bool isMovingEnoughToWake() const noexcept
+			{
+				const auto& vel(getVelocity());
+				const auto threshold(this->world.sleepSettings.velocityThreshold);
+				return vel.x * vel.x + vel.y * vel.y > threshold * threshold;
+			}
+
+			// Continuous bodies moving at least their own width or height in a frame sweep their old shape to the new one, and stop at the earliest
+			// body they must resolve against that lies on the way, penetrating it by one unit so that regular resolution handles the contact
+			// Other bodies are considered still, at their current position; entries of an attached `StaticLevel` are swept against too, and only
+			// the ones on the way get a proxy
+			inline void sweep()
 			{
+				const auto& oldShape(getOldShape());
+				auto& shape(getShape());
+				const Vec2i delta{shape.getPosition() - oldShape.getPosition()};
+				if(std::abs(delta.x) < shape.getWidth() && std::abs(delta.y) < shape.getHeight()) return;
+
+				const AABB swept{std::min(oldShape.getLeft(), shape.getLeft()), std::max(oldShape.getRight(), shape.getRight()) + 1,
+					std::min(oldShape.getTop(), shape.getTop()), std::max(oldShape.getBottom(), shape.getBottom()) + 1};
+
+				Body* hit{nullptr};
+				float hitTime{0.f};
+				bool hitAxisX{false};
+
+				auto isOnTheWay([&](const AABB& mShape, float& mT, bool& mAxisX)
+				{
+					return Utils::getSweptEntry(oldShape, delta, mShape, mT, mAxisX) && (hit == nullptr || mT <= hitTime);
+				});
+				auto consider([&](Body& mBody, float mT, bool mAxisX)
+				{
+					if(hit != nullptr && mT == hitTime && mBody.getHandle() > hit->getHandle()) return;
+
+					hit = &mBody;
+					hitTime = mT;
+					hitAxisX = mAxisX;
+				});
+				auto mustStopAt([this](const Body& mBody){ return &mBody != this && this->mustCheck(mBody) && mustResolveAgainst(mBody); });
+
+				this->world.spatial.forEachOverlapping(swept, mustStopAt, [&](Body& mBody)
+				{
+					float t;
+					bool axisX;
+					if(isOnTheWay(mBody.getShape(), t, axisX)) consider(mBody, t, axisX);
+				});
+
+				this->world.forEachLevelEntry(swept, [&](const AABB& mShape, const auto& mGetProxy)
+				{
+					float t;
+					bool axisX;
+					if(!isOnTheWay(mShape, t, axisX)) return;
+
+					auto& proxy(mGetProxy());
+					if(mustStopAt(proxy)) consider(proxy, t, axisX);
+				});
+
+				if(hit == nullptr) return;
+
+				const auto& s(hit->getShape());
+				Vec2i pos{oldShape.getPosition() + Vec2i(Vec2f(delta) * hitTime)};
+				if(hitAxisX) pos.x = delta.x > 0 ? s.getLeft() + 1 - shape.getHalfWidth() : s.getRight() - 1 + shape.getHalfWidth();
+				else pos.y = delta.y > 0 ? s.getTop() + 1 - shape.getHalfHeight() : s.getBottom() - 1 + shape.getHalfHeight();
+				shape.setPosition(pos);
+			}
+
+			inline void integrate(FT mFT) noexcept { getStore().integrate(getStoreIdx(), mFT); }
+
+			// A frame is split in phases, run in this order: `beginStep`, `integrate`, `detect`, `resolve`, `endStep`
+			// Bodies that do not move this frame (static or out of bounds) stop after `beginStep`
+			inline bool beginStep()
+			{
+				if(isProxy()) return false;
 				if(mustInit) { this->spatialInfo.template init<BodyTag>(); mustInit = false; }
 
-				ssvs::nullify(data.lastResolution);
+				ssvs::nullify(getStore().lastResolutions[getStoreIdx()]);
 
 				this->onPreUpdate();
 
-				if(isStatic()) { this->spatialInfo.template preUpdate<BodyTag>(); return; }
-				if(this->outOfBounds) { onOutOfBounds(); this->outOfBounds = false; return; }
-				data.oldShape = getShape();
-				data.oldVelocity = getVelocity();
-				integrate(mFT);
-				this->spatialInfo.template preUpdate<BodyTag>();
+				if(isStatic()) { this->spatialInfo.template preUpdate<BodyTag>(); return false; }
+				if(this->outOfBounds) { SSVSC_STATS_COUNT(this->world, outOfBounds, 1); onOutOfBounds(); this->outOfBounds = false; return false; }
+				if(isAsleep()) return false;
+				getOldShape() = getShape();
+				getStore().oldVelocities[getStoreIdx()] = getVelocity();
+				stepFrame = this->world.frame;
+				return true;
+			}
+			inline void detect(FT mFT)
+			{
+				if(isContinuous()) sweep();
 
-				toResolve.clear();
-				this->spatialInfo.template handleCollisions<BodyTag>(mFT);
+				{
+					SSVSC_STATS_TIME(this->world, StatsPhase::SpatialUpdate);
+					this->spatialInfo.template preUpdate<BodyTag>();
+				}
 
-				this->world.resolver.resolve(*this, toResolve);
+				SSVSC_STATS_TIME(this->world, StatsPhase::Detection);
+				refreshPairs();
+				this->spatialInfo.template handleCollisions<BodyTag>(mFT);
+			}
+			inline void resolve() { this->world.resolver.resolve(*this, toResolve); }
+			inline void endStep()
+			{
 				if(getOldShape() != getShape()) this->spatialInfo.invalidate();
 
-				this->spatialInfo.postUpdate(); onPostUpdate();
+				this->spatialInfo.template postUpdate<BodyTag>(); onPostUpdate();
+				updateSleep();
+			}
+
+			inline void update(FT mFT)
+			{
+				if(!beginStep()) return;
+
+				{
+					SSVSC_STATS_TIME(this->world, StatsPhase::Integrate);
+					integrate(mFT);
+				}
+
+				detect(mFT);
+
+				{
+					SSVSC_STATS_TIME(this->world, StatsPhase::Resolution);
+					SSVSC_STATS_COUNT(this->world, resolutions, toResolve.size());
+					resolve();
+				}
+
+				endStep();
+			}
+
+			// Resolvers report resolutions through this, so that `onResolution` follows the world's event dispatch mode
+			inline void dispatchResolution(Body& mBody, const Vec2i& mResolution, bool& mNoResolvePosition, bool& mNoResolveVelocity)
+			{
+				if(this->world.isDeferringEvents()) this->world.getEventBuffer().push(Impl::EventType::Resolution, *this, &mBody, mResolution);
+				else onResolution({mBody, mBody.getUserData(), mResolution, mNoResolvePosition, mNoResolveVelocity});
+			}
+			inline void dispatchContact(Impl::EventType mType, Body* mBody)
+			{
+				if(this->world.isDeferringEvents()) { this->world.getEventBuffer().push(mType, *this, mBody); return; }
+
+				const ContactInfoType info{mBody, mBody != nullptr ? mBody->getUserData() : nullptr};
+				if(mType == Impl::EventType::ContactBegin) onContactBegin(info);
+				else if(mType == Impl::EventType::ContactStay) onContactStay(info);
+				else onContactEnd(info);
+			}
+
+			// Every piece of simulation state of the body, for `World::snapshot` and `World::freeze`: store data, flags, groups, sleep and pair bookkeeping, and resolver info
+			// Resting contacts are written as `mGetId(body)`; contacts for which it returns `BodyStore::null` are left out
+			template<typename TF> inline void writeState(Impl::BlobWriter& mWriter, TF mGetId) const
+			{
+				const auto& store(getStore());
+				const auto idx(getStoreIdx());
+
+				mWriter.write(store.shapes[idx]);
+				mWriter.write(store.oldShapes[idx]);
+				mWriter.write(store.velocities[idx]);
+				mWriter.write(store.oldVelocities[idx]);
+				mWriter.write(store.accelerations[idx]);
+				mWriter.write(store.restitutions[idx]);
+				mWriter.write(store.lastResolutions[idx]);
+				mWriter.write(store.masses[idx]);
+				mWriter.write(store.invMasses[idx]);
+				mWriter.write(store.flags[idx]);
+				mWriter.write(std::uint8_t(this->outOfBounds));
+				mWriter.write(this->getGroups());
+				mWriter.write(this->getGroupsToCheck());
+				mWriter.write(this->getGroupsNoResolve());
+				mWriter.write(std::uint64_t(restFrames));
+				mWriter.write(std::uint64_t(pairFrame));
+				mWriter.write(std::uint64_t(stepFrame));
+				constexpr auto null(BodyStore<TW>::null);
+				SizeT contactCount{0};
+				for(const auto& b : restingContacts) if(mGetId(*b) != null) ++contactCount;
+
+				mWriter.write(std::uint64_t(contactCount));
+				for(const auto& b : restingContacts) if(mGetId(*b) != null) mWriter.write(std::uint64_t(mGetId(*b)));
+				ResolverInfoType::writeState(mWriter);
+			}
+
+			// Reads back `writeState`, with `mGetBody(id)` returning the resting contact written as `id` (or `nullptr` if there is none)
+			// The spatial info is left untouched: `World::restore` re-inserts every body once all of them are restored
+			template<typename TF> inline void readState(Impl::BlobReader& mReader, TF mGetBody)
+			{
+				auto& store(getStore());
+				const auto idx(getStoreIdx());
+
+				store.shapes[idx] = mReader.readShape();
+				store.oldShapes[idx] = mReader.readShape();
+				store.velocities[idx] = mReader.read<Vec2f>();
+				store.oldVelocities[idx] = mReader.read<Vec2f>();
+				store.accelerations[idx] = mReader.read<Vec2f>();
+				store.restitutions[idx] = mReader.read<Vec2f>();
+				store.lastResolutions[idx] = mReader.read<Vec2i>();
+				store.masses[idx] = mReader.read<float>();
+				store.invMasses[idx] = mReader.read<float>();
+				store.flags[idx] = mReader.read<std::uint8_t>();
+				this->outOfBounds = mReader.read<std::uint8_t>() != 0;
+
+				const auto groups(mReader.readGroups()), groupsToCheck(mReader.readGroups()), groupsNoResolve(mReader.readGroups());
+				this->setAllGroups(groups, groupsToCheck, groupsNoResolve);
+
+				restFrames = mReader.read<std::uint64_t>();
+				pairFrame = mReader.read<std::uint64_t>();
+				stepFrame = mReader.read<std::uint64_t>();
+				toResolve.clear();
+				detected.clear();
+
+				restingContacts.resize(mReader.readCount(sizeof(std::uint64_t)));
+				for(auto& b : restingContacts)
+				{
+					b = mGetBody(mReader.read<std::uint64_t>());
+					if(b == nullptr) throw std::runtime_error{"ssvsc::Body::readState: missing resting contact"};
+				}
+
+				ResolverInfoType::readState(mReader);
 			}
 
 			inline void handleCollision(FT mFT, Body* mBody)
 			{
-				if(mBody == this || !this->mustCheck(*mBody) || !getShape().isOverlapping(mBody->getShape())) return;
+				if(mBody == this) return;
+				SSVSC_STATS_COUNT(this->world, candidatePairs, 1);
+
+				// Each unordered pair is processed once per frame: if `mBody` already found this body, both directions were dispatched
+				refreshPairs();
+				mBody->refreshPairs();
+				if(ssvu::contains(detected, mBody)) return;
+
+				if(!this->mustCheck(*mBody) || !getShape().isOverlapping(mBody->getShape())) return;
+
+				SSVSC_STATS_COUNT(this->world, overlaps, 1);
+				detected.emplace_back(mBody);
+				mBody->detected.emplace_back(this);
 
-				this->onDetection({*mBody, mBody->getUserData(), mFT});
-				mBody->onDetection({*this, userData, mFT});
+				// Only bodies moving faster than the sleep threshold wake what they touch, so that piles of resting bodies can fall asleep
+				if(mBody->isAsleep() && isMovingEnoughToWake()) mBody->wake();
 
+				// Without contact tracking every frame of an overlap is a detection; with it, only the first one is, unless `detectionEveryFrame` is set
+				const auto& settings(this->world.contactSettings);
+				const bool began{settings.enabled && this->world.contacts.touch(getStore(), *this, *mBody, this->world.frame)};
+				if(!settings.enabled || began || settings.detectionEveryFrame)
+				{
+					this->dispatchDetection(*mBody, mFT);
+					mBody->dispatchDetection(*this, mFT);
+				}
+
+				if(began) { dispatchContact(Impl::EventType::ContactBegin, mBody); mBody->dispatchContact(Impl::EventType::ContactBegin, this); }
+				else if(settings.enabled && settings.stayEvents) { dispatchContact(Impl::EventType::ContactStay, mBody); mBody->dispatchContact(Impl::EventType::ContactStay, this); }
+
+				// `mBody` will not look for this pair again, so it gets its resolution entry now
 				if(mustResolveAgainst(*mBody)) toResolve.emplace_back(mBody);
+				if(!mBody->isStatic() && mBody->mustCheck(*this) && mBody->mustResolveAgainst(*this)) mBody->toResolve.emplace_back(this);
 			}
 
 		public:
@@ -79,54 +348,116 @@ namespace ssvsc
 			ssvu::Delegate<void()> onPostUpdate, onOutOfBounds;
 			ssvu::Delegate<void(const ResolutionInfoType&)> onResolution;
 
-			inline Body(TW& mWorld, bool mIsStatic, const Vec2i& mPos, const Vec2i& mSize) noexcept : Base<TW>{mWorld}, data{mIsStatic, mPos, mSize} { }
-			inline ~Body() noexcept { destroy(); }
-			inline void destroy() { this->spatialInfo.template destroy<BodyTag>(); this->world.delBody(this); }
-
-			inline void applyAccel(const Vec2f& mAccel) noexcept		{ data.acceleration += mAccel; }
-			inline void resolvePosition(const Vec2i& mOffset) noexcept	{ data.shape.move(mOffset); data.lastResolution += mOffset; }
-
-			inline void setPosition(const Vec2i& mPos)					{ data.oldShape = getShape(); data.shape.setPosition(mPos);	this->spatialInfo.invalidate(); }
-			inline void setX(int mX)									{ data.oldShape = getShape(); data.shape.setX(mX);			this->spatialInfo.invalidate(); }
-			inline void setY(int mY)									{ data.oldShape = getShape(); data.shape.setY(mY);			this->spatialInfo.invalidate(); }
-			inline void setSize(const Vec2i& mSize)						{ data.shape.setSize(mSize);								this->spatialInfo.invalidate(); }
-			inline void setHalfSize(const Vec2i& mSize)					{ data.shape.setHalfSize(mSize);							this->spatialInfo.invalidate(); }
-			inline void setWidth(int mWidth)							{ data.shape.setWidth(mWidth);								this->spatialInfo.invalidate(); }
-			inline void setHeight(int mHeight)							{ data.shape.setHeight(mHeight);							this->spatialInfo.invalidate(); }
-			inline void setStatic(bool mStatic)							{ data._static = mStatic;									this->spatialInfo.invalidate(); }
-			inline void setVelocity(const Vec2f& mVel) noexcept			{ data.velocity = mVel; }
-			inline void setAcceleration(const Vec2f& mAccel) noexcept	{ data.acceleration = mAccel; }
+			// Contact events track each overlapping pair over time, once enabled with `World::setContactSettings`: `onContactBegin` fires on the first frame
+			// of an overlap, `onContactStay` on the following ones (with `stayEvents`), and `onContactEnd` once the pair is not detected anymore (at the end of the world update)
+			ssvu::Delegate<void(const ContactInfoType&)> onContactBegin, onContactStay, onContactEnd;
+
+			inline Body(TW& mWorld, bool mIsStatic, const Vec2i& mPos, const Vec2i& mSize) : Base<TW>{mWorld}, handle{mWorld.bodyStore.create(*this, {mIsStatic, mPos, mSize})}
+			{
+				this->onGroupsChanged = [](Groupable& mX){ static_cast<Body&>(mX).spatialInfo.template refreshGroups<BodyTag>(); };
+			}
+			// Used by `World::restore` to recreate a body of a snapshot with its original handle; its state is restored right after
+			inline Body(TW& mWorld, BodyHandle mHandle, std::uint32_t mGeneration) : Base<TW>{mWorld}, handle{mWorld.bodyStore.create(*this, {false, {}, {}}, mHandle, mGeneration)}
+			{
+				this->onGroupsChanged = [](Groupable& mX){ static_cast<Body&>(mX).spatialInfo.template refreshGroups<BodyTag>(); };
+			}
+			// Used by `World::getLevelProxy` to stand in for the entry `mLevelId` of a `StaticLevel`: proxies are static, and never stepped nor inserted in the spatial structure
+			inline Body(TW& mWorld, std::uint32_t mLevelId, const AABB& mShape, const GroupBitset& mGroups, const GroupBitset& mGroupsToCheck)
+				: Base<TW>{mWorld}, handle{mWorld.bodyStore.create(*this, {true, mShape.getPosition(), mShape.getSize()})}, levelId{mLevelId}, mustInit{false}
+			{
+				getStore().setFlag(getStoreIdx(), BodyFlag::Proxy, true);
+				this->setAllGroups(mGroups, mGroupsToCheck, {});
+				this->onGroupsChanged = [](Groupable& mX){ static_cast<Body&>(mX).spatialInfo.template refreshGroups<BodyTag>(); };
+			}
+			inline ~Body() noexcept { destroy(); getStore().destroy(handle); }
+			// Destroyed bodies stay in `World::getBodies` until the next update (see `isAlive`); destroying one again does nothing
+			inline void destroy()
+			{
+				if(destroyed) return;
+				destroyed = true;
+
+				// Bodies resting against this one lose their support
+				releaseRestingContacts();
+
+				this->spatialInfo.template destroy<BodyTag>(); this->world.delBody(this);
+			}
+
+			// Wakes the body up, along with every sleeping body it was resting against
+			inline void wake()
+			{
+				if(!isAsleep()) return;
+
+				std::vector<Body*> toWake{this};
+				while(!toWake.empty())
+				{
+					auto& b(*toWake.back());
+					toWake.pop_back();
+					if(!b.isAsleep()) continue;
+
+					b.getStore().setFlag(b.getStoreIdx(), BodyFlag::Asleep, false);
+					b.restFrames = 0;
+					for(const auto& c : b.restingContacts) if(c->isAsleep()) toWake.emplace_back(c);
+				}
+			}
+
+			inline void applyAccel(const Vec2f& mAccel)					{ wake(); getStore().accelerations[getStoreIdx()] += mAccel; }
+			inline void resolvePosition(const Vec2i& mOffset) noexcept	{ getShape().move(mOffset); getStore().lastResolutions[getStoreIdx()] += mOffset; }
+
+			inline void setPosition(const Vec2i& mPos)					{ wake(); getOldShape() = getShape(); getShape().setPosition(mPos);	this->spatialInfo.invalidate(); }
+			inline void setX(int mX)									{ wake(); getOldShape() = getShape(); getShape().setX(mX);			this->spatialInfo.invalidate(); }
+			inline void setY(int mY)									{ wake(); getOldShape() = getShape(); getShape().setY(mY);			this->spatialInfo.invalidate(); }
+			inline void setSize(const Vec2i& mSize)						{ wake(); getShape().setSize(mSize);								this->spatialInfo.invalidate(); }
+			inline void setHalfSize(const Vec2i& mSize)					{ wake(); getShape().setHalfSize(mSize);							this->spatialInfo.invalidate(); }
+			inline void setWidth(int mWidth)							{ wake(); getShape().setWidth(mWidth);								this->spatialInfo.invalidate(); }
+			inline void setHeight(int mHeight)							{ wake(); getShape().setHeight(mHeight);							this->spatialInfo.invalidate(); }
+			inline void setStatic(bool mStatic)							{ wake(); getStore().setFlag(getStoreIdx(), BodyFlag::Static, mStatic);	this->spatialInfo.invalidate(); }
+			inline void setVelocity(const Vec2f& mVel)					{ wake(); getStore().velocities[getStoreIdx()] = mVel; }
+			inline void setAcceleration(const Vec2f& mAccel)			{ wake(); getStore().accelerations[getStoreIdx()] = mAccel; }
 			inline void setUserData(void* mUserData) noexcept			{ userData = mUserData; }
-			inline void setVelocityX(float mX) noexcept					{ data.velocity.x = mX; }
-			inline void setVelocityY(float mY) noexcept					{ data.velocity.y = mY; }
-			inline void setResolve(bool mResolve) noexcept				{ data.resolve = mResolve; }
-			inline void setMass(float mMass) noexcept					{ data.setMass(mMass); }
-			inline void setRestitutionX(float mX) noexcept				{ data.restitution.x = mX; }
-			inline void setRestitutionY(float mY) noexcept				{ data.restitution.y = mY; }
-
-			inline AABB& getShape() noexcept						{ return data.shape; }
-			inline AABB& getOldShape() noexcept						{ return data.oldShape; }
-			inline const AABB& getShape() const noexcept			{ return data.shape; }
-			inline const AABB& getOldShape() const noexcept			{ return data.oldShape; }
+			inline void setVelocityX(float mX)							{ wake(); getStore().velocities[getStoreIdx()].x = mX; }
+			inline void setVelocityY(float mY)							{ wake(); getStore().velocities[getStoreIdx()].y = mY; }
+			inline void setResolve(bool mResolve) noexcept				{ getStore().setFlag(getStoreIdx(), BodyFlag::Resolve, mResolve); }
+			inline void setContinuous(bool mContinuous) noexcept		{ getStore().setFlag(getStoreIdx(), BodyFlag::Continuous, mContinuous); }
+			inline void setMass(float mMass) noexcept
+			{
+				const auto idx(getStoreIdx());
+				getStore().masses[idx] = mMass;
+				getStore().invMasses[idx] = mMass == 0 ? 0 : (1.f / mMass);
+			}
+			inline void setRestitutionX(float mX) noexcept				{ getStore().restitutions[getStoreIdx()].x = mX; }
+			inline void setRestitutionY(float mY) noexcept				{ getStore().restitutions[getStoreIdx()].y = mY; }
+
+			// The references returned below point into the world's `BodyStore`, which moves the last body's data into the slot of a removed one:
+			// they survive the creation of bodies, but may refer to another body (or to nothing) once a destroyed body is removed, which
+			// `World::update`, `snapshot`, `restore` and `setStaticLevel` do first; copy the values to keep them across those calls
+			inline AABB& getShape() noexcept						{ return getStore().shapes[getStoreIdx()]; }
+			inline AABB& getOldShape() noexcept						{ return getStore().oldShapes[getStoreIdx()]; }
+			inline const AABB& getShape() const noexcept			{ return getStore().shapes[getStoreIdx()]; }
+			inline const AABB& getOldShape() const noexcept			{ return getStore().oldShapes[getStoreIdx()]; }
 			inline const auto& getPosition() const noexcept			{ return getShape().getPosition(); }
-			inline const auto& getVelocity() const noexcept			{ return data.velocity; }
+			inline const auto& getVelocity() const noexcept			{ return getStore().velocities[getStoreIdx()]; }
 			inline const auto& getOldPosition() const noexcept		{ return getOldShape().getPosition(); }
-			inline const auto& getOldVelocity() const noexcept		{ return data.oldVelocity; }
-			inline const auto& getAcceleration() const noexcept		{ return data.acceleration; }
+			inline const auto& getOldVelocity() const noexcept		{ return getStore().oldVelocities[getStoreIdx()]; }
+			inline const auto& getAcceleration() const noexcept		{ return getStore().accelerations[getStoreIdx()]; }
 			inline auto getSize() const noexcept					{ return getShape().getSize(); }
-			inline auto getMass() const noexcept					{ return isStatic() ? 0 : data.mass; }
-			inline auto getInvMass() const noexcept					{ return isStatic() ? 0 : data.invMass; }
+			inline auto getMass() const noexcept					{ return isStatic() ? 0 : getStore().masses[getStoreIdx()]; }
+			inline auto getInvMass() const noexcept					{ return isStatic() ? 0 : getStore().invMasses[getStoreIdx()]; }
 			inline int getWidth() const noexcept					{ return getShape().getWidth(); }
 			inline int getHeight() const noexcept					{ return getShape().getHeight(); }
-			inline bool isStatic() const noexcept					{ return data._static; }
+			inline bool isStatic() const noexcept					{ return getStore().hasFlag(getStoreIdx(), BodyFlag::Static); }
+			inline bool isAsleep() const noexcept					{ return getStore().hasFlag(getStoreIdx(), BodyFlag::Asleep); }
+			inline bool isContinuous() const noexcept				{ return getStore().hasFlag(getStoreIdx(), BodyFlag::Continuous); }
+			inline bool isProxy() const noexcept					{ return getStore().hasFlag(getStoreIdx(), BodyFlag::Proxy); }
+			inline bool isAlive() const noexcept					{ return !destroyed; }
 			inline bool hasMovedLeft() const noexcept				{ return getShape().getX() < getOldShape().getX(); }
 			inline bool hasMovedRight() const noexcept				{ return getShape().getX() > getOldShape().getX(); }
 			inline bool hasMovedUp() const noexcept					{ return getShape().getY() < getOldShape().getY(); }
 			inline bool hasMovedDown() const noexcept				{ return getShape().getY() > getOldShape().getY(); }
-			inline bool getResolve() const noexcept					{ return data.resolve; }
-			inline const auto& getLastResolution() const noexcept	{ return data.lastResolution; }
-			inline float getRestitutionX() const noexcept			{ return data.restitution.x; }
-			inline float getRestitutionY() const noexcept			{ return data.restitution.y; }
+			inline bool getResolve() const noexcept					{ return getStore().hasFlag(getStoreIdx(), BodyFlag::Resolve); }
+			inline const auto& getLastResolution() const noexcept	{ return getStore().lastResolutions[getStoreIdx()]; }
+			inline float getRestitutionX() const noexcept			{ return getStore().restitutions[getStoreIdx()].x; }
+			inline float getRestitutionY() const noexcept			{ return getStore().restitutions[getStoreIdx()].y; }
+			inline BodyHandle getHandle() const noexcept			{ return handle; }
 
 			inline void* getUserData() const noexcept { return userData; }
 			template<typename T> inline T getUserData() const noexcept { return static_cast<T>(userData); }
@@ -0,0 +1,190 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_BODY_BODYSTORE
+#define SSVSC_BODY_BODYSTORE
+
+namespace ssvsc
+{
+	template<typename TW> class Body;
+
+	namespace BodyFlag
+	{
+		constexpr std::uint8_t Static{1u << 0};
+		constexpr std::uint8_t Resolve{1u << 1};
+		constexpr std::uint8_t Asleep{1u << 2};
+		constexpr std::uint8_t Continuous{1u << 3};
+		constexpr std::uint8_t Proxy{1u << 4};
+		constexpr std::uint8_t Stepping{1u << 5};
+	}
+
+	// Structure-of-arrays storage for the hot per-body data of a world
+	// Arrays are kept dense (destroying a body moves the last one in its place), and bodies refer to their slot through a stable handle
+	// Growing never moves elements, but `destroy` does: references to elements (and indices) are only valid until a slot is destroyed
+	template<typename TW> struct BodyStore
+	{
+		public:
+			using BodyType = Body<TW>;
+			template<typename T> using ArrayType = Impl::PagedVector<T>;
+			static constexpr SizeT null{ssvu::NumLimits<SizeT>::max()};
+
+			ArrayType<AABB> shapes, oldShapes;
+			ArrayType<Vec2f> velocities, oldVelocities, accelerations, restitutions;
+			ArrayType<Vec2i> lastResolutions;
+			ArrayType<float> masses, invMasses;
+			ArrayType<std::uint8_t> flags;
+			ArrayType<BodyType*> owners;
+
+		private:
+			std::vector<SizeT> handleToIdx, idxToHandle, freeHandles;
+			std::vector<std::uint32_t> generations;
+
+			template<typename T> inline static void swapPop(ArrayType<T>& mArray, SizeT mIdx) { mArray[mIdx] = std::move(mArray.back()); mArray.pop_back(); }
+
+			inline void insert(BodyType& mOwner, const BodyData& mData, BodyHandle mHandle)
+			{
+				handleToIdx[mHandle] = getSize();
+				idxToHandle.emplace_back(mHandle);
+
+				shapes.emplace_back(mData.shape);
+				oldShapes.emplace_back(mData.oldShape);
+				velocities.emplace_back(mData.velocity);
+				oldVelocities.emplace_back(mData.oldVelocity);
+				accelerations.emplace_back(mData.acceleration);
+				restitutions.emplace_back(mData.restitution);
+				lastResolutions.emplace_back(mData.lastResolution);
+				masses.emplace_back(mData.mass);
+				invMasses.emplace_back(mData.invMass);
+				flags.emplace_back((mData._static ? BodyFlag::Static : 0) | (mData.resolve ? BodyFlag::Resolve : 0));
+				owners.emplace_back(&mOwner);
+			}
+
+		public:
+			inline BodyHandle create(BodyType& mOwner, const BodyData& mData)
+			{
+				// Free handles can only be stale (taken by a restored body) when a restore failed before `readHandles`
+				while(!freeHandles.empty() && isAlive(freeHandles.back())) freeHandles.pop_back();
+
+				BodyHandle handle;
+				if(freeHandles.empty()) { handle = handleToIdx.size(); handleToIdx.emplace_back(); generations.emplace_back(0); }
+				else { handle = freeHandles.back(); freeHandles.pop_back(); }
+
+				insert(mOwner, mData, handle);
+				return handle;
+			}
+
+			// Creates the slot of a body at a given free handle and generation, used to recreate bodies when restoring a snapshot
+			// The free handles are left as they are, stale, until `readHandles` replaces them: it must be called before any other body is created
+			inline BodyHandle create(BodyType& mOwner, const BodyData& mData, BodyHandle mHandle, std::uint32_t mGeneration)
+			{
+				if(handleToIdx.size() <= mHandle) { handleToIdx.resize(mHandle + 1, SizeT(null)); generations.resize(mHandle + 1, 0); }
+				SSVU_ASSERT(!isAlive(mHandle));
+
+				generations[mHandle] = mGeneration;
+				insert(mOwner, mData, mHandle);
+				return mHandle;
+			}
+			// Moves the data of the last slot into the destroyed one: references to either slot's elements no longer refer to the same body
+			inline void destroy(BodyHandle mHandle)
+			{
+				const auto idx(getIdx(mHandle)), lastIdx(getSize() - 1);
+
+				swapPop(shapes, idx);
+				swapPop(oldShapes, idx);
+				swapPop(velocities, idx);
+				swapPop(oldVelocities, idx);
+				swapPop(accelerations, idx);
+				swapPop(restitutions, idx);
+				swapPop(lastResolutions, idx);
+				swapPop(masses, idx);
+				swapPop(invMasses, idx);
+				swapPop(flags, idx);
+				swapPop(owners, idx);
+
+				const auto movedHandle(idxToHandle[lastIdx]);
+				handleToIdx[movedHandle] = idx;
+				idxToHandle[idx] = movedHandle;
+				idxToHandle.pop_back();
+				handleToIdx[mHandle] = null;
+
+				++generations[mHandle];
+				freeHandles.emplace_back(mHandle);
+			}
+
+			inline SizeT getIdx(BodyHandle mHandle) const noexcept	{ SSVU_ASSERT(mHandle < handleToIdx.size()); return handleToIdx[mHandle]; }
+			inline BodyHandle getHandle(SizeT mIdx) const noexcept	{ SSVU_ASSERT(mIdx < idxToHandle.size()); return idxToHandle[mIdx]; }
+			inline SizeT getSize() const noexcept					{ return idxToHandle.size(); }
+			inline bool isAlive(BodyHandle mHandle) const noexcept	{ return mHandle < handleToIdx.size() && handleToIdx[mHandle] != null; }
+
+			// Incremented every time the handle is released, telling apart the successive bodies using it
+			inline std::uint32_t getGeneration(BodyHandle mHandle) const noexcept { SSVU_ASSERT(mHandle < generations.size()); return generations[mHandle]; }
+
+			// The handle table (generations and free handles, in reuse order) is part of snapshots, so that restored worlds hand out the same handles
+			// Live handles for which `mIsSaved(handle)` is false are written as if their body had been destroyed
+			template<typename TF> inline void writeHandles(Impl::BlobWriter& mWriter, TF mIsSaved) const
+			{
+				auto isDropped([this, &mIsSaved](BodyHandle mHandle){ return isAlive(mHandle) && !mIsSaved(mHandle); });
+
+				mWriter.write(std::uint64_t(generations.size()));
+				for(auto h(0u); h < generations.size(); ++h) mWriter.write(std::uint32_t(generations[h] + (isDropped(h) ? 1 : 0)));
+
+				SizeT dropped{0};
+				for(auto h(0u); h < handleToIdx.size(); ++h) if(isDropped(h)) ++dropped;
+
+				mWriter.write(std::uint64_t(freeHandles.size() + dropped));
+				for(const auto& h : freeHandles) mWriter.write(std::uint64_t(h));
+				for(auto h(0u); h < handleToIdx.size(); ++h) if(isDropped(h)) mWriter.write(std::uint64_t(h));
+			}
+
+			// Must be called once the live bodies are exactly the ones of the snapshot: handles past the end of its table must all be free
+			// Free handles must be distinct and not alive, as `create` hands them out as they are; the table is left untouched if they are not
+			inline void readHandles(Impl::BlobReader& mReader)
+			{
+				const auto count(mReader.readCount(sizeof(std::uint32_t)));
+				for(auto h(count); h < handleToIdx.size(); ++h)
+					if(isAlive(h)) throw std::runtime_error{"ssvsc::BodyStore::readHandles: live handle missing from the snapshot"};
+
+				std::vector<std::uint32_t> readGenerations(count);
+				for(auto& g : readGenerations) g = mReader.read<std::uint32_t>();
+
+				std::vector<SizeT> readFreeHandles(mReader.readCount(sizeof(std::uint64_t)));
+				std::vector<bool> free(count, false);
+				for(auto& h : readFreeHandles)
+				{
+					const auto handle(mReader.read<std::uint64_t>());
+					if(handle >= count || isAlive(handle) || free[handle]) throw std::runtime_error{"ssvsc::BodyStore::readHandles: invalid free handle"};
+
+					h = handle;
+					free[h] = true;
+				}
+
+				handleToIdx.resize(count, SizeT(null));
+				generations = std::move(readGenerations);
+				freeHandles = std::move(readFreeHandles);
+			}
+
+			// Integrates the body at `mIdx`, consuming its acceleration
+			inline void integrate(SizeT mIdx, FT mFT) noexcept
+			{
+				velocities[mIdx] += accelerations[mIdx] * mFT;
+				shapes[mIdx].move(Vec2i(velocities[mIdx] * mFT));
+				ssvs::nullify(accelerations[mIdx]);
+			}
+
+			// Integrates the bodies flagged `Stepping` in `[mBegin, mEnd)`, walking the arrays in order instead of going through each body's handle
+			inline void integrate(SizeT mBegin, SizeT mEnd, FT mFT) noexcept
+			{
+				for(auto i(mBegin); i < mEnd; ++i) if(hasFlag(i, BodyFlag::Stepping)) integrate(i, mFT);
+			}
+
+			inline bool hasFlag(SizeT mIdx, std::uint8_t mFlag) const noexcept	{ return (flags[mIdx] & mFlag) != 0; }
+			inline void setFlag(SizeT mIdx, std::uint8_t mFlag, bool mOn) noexcept
+			{
+				if(mOn) flags[mIdx] |= mFlag;
+				else flags[mIdx] &= ~mFlag;
+			}
+	};
+}
+
+#endif
@@ -8,6 +8,7 @@
 namespace ssvsc
 {
 	template<typename TW> class Body;
+	template<typename TW> class Sensor;
 
 	template<typename TW> struct DetectionInfo
 	{
@@ -16,6 +17,19 @@ namespace ssvsc
 		float frameTime;
 	};
 
+	template<typename TW> struct SensorDetectionInfo
+	{
+		Sensor<TW>& sensor;
+		float frameTime;
+	};
+
+	// `body` is `nullptr` when a contact ends because the other body was destroyed
+	template<typename TW> struct ContactInfo
+	{
+		Body<TW>* body;
+		void* userData;
+	};
+
 	template<typename TW> struct ResolutionInfo
 	{
 		Body<TW>& body;
@@ -12,15 +12,21 @@ namespace ssvsc
 		private:
 			GroupBitset groups, groupsToCheck, groupsNoResolve;
 
+			inline void notifyGroupsChanged() noexcept { if(onGroupsChanged != nullptr) onGroupsChanged(*this); }
+
+		protected:
+			// Called after `groups` or `groupsToCheck` change, so that spatial structures storing copies of them can stay in sync
+			void(*onGroupsChanged)(Groupable&){nullptr};
+
 		public:
-			inline void setGroups(bool mOn, Group mGroup) noexcept														{ groups[mGroup] = mOn; }
+			inline void setGroups(bool mOn, Group mGroup) noexcept														{ groups[mGroup] = mOn; notifyGroupsChanged(); }
 			inline void addGroups(Group mGroup) noexcept																{ setGroups(true, mGroup); }
 			inline void delGroups(Group mGroup) noexcept																{ setGroups(false, mGroup); }
 			template<typename... TGroups> inline void setGroups(bool mOn, Group mGroup, TGroups... mGroups) noexcept	{ setGroups(mOn, mGroup); setGroups(mOn, mGroups...); }
 			template<typename... TGroups> inline void addGroups(Group mGroup, TGroups... mGroups) noexcept				{ addGroups(mGroup); addGroups(mGroups...); }
 			template<typename... TGroups> inline void delGroups(Group mGroup, TGroups... mGroups) noexcept				{ delGroups(mGroup); delGroups(mGroups...); }
 
-			inline void setGroupsToCheck(bool mOn, Group mGroup) noexcept													{ groupsToCheck[mGroup] = mOn; }
+			inline void setGroupsToCheck(bool mOn, Group mGroup) noexcept													{ groupsToCheck[mGroup] = mOn; notifyGroupsChanged(); }
 			inline void addGroupsToCheck(Group mGroup) noexcept																{ setGroupsToCheck(true, mGroup); }
 			inline void delGroupsToCheck(Group mGroup) noexcept																{ setGroupsToCheck(false, mGroup); }
 			template<typename... TGroups> inline void setGroupsToCheck(bool mOn, Group mGroup, TGroups... mGroups) noexcept	{ setGroupsToCheck(mOn, mGroup); setGroupsToCheck(mOn, mGroups...); }
@@ -34,10 +40,18 @@ namespace ssvsc
 			template<typename... TGroups> inline void addGroupsNoResolve(Group mGroup, TGroups... mGroups) noexcept				{ addGroupsNoResolve(mGroup); addGroupsNoResolve(mGroups...); }
 			template<typename... TGroups> inline void delGroupsNoResolve(Group mGroup, TGroups... mGroups) noexcept				{ delGroupsNoResolve(mGroup); delGroupsNoResolve(mGroups...); }
 
-			inline void clearGroups() noexcept			{ groups.reset(); }
-			inline void clearGroupsToCheck() noexcept	{ groupsToCheck.reset(); }
+			inline void clearGroups() noexcept			{ groups.reset(); notifyGroupsChanged(); }
+			inline void clearGroupsToCheck() noexcept	{ groupsToCheck.reset(); notifyGroupsChanged(); }
 			inline void clearGroupsNoResolve() noexcept	{ groupsNoResolve.reset(); }
 
+			inline void setAllGroups(const GroupBitset& mGroups, const GroupBitset& mGroupsToCheck, const GroupBitset& mGroupsNoResolve) noexcept
+			{
+				groups = mGroups;
+				groupsToCheck = mGroupsToCheck;
+				groupsNoResolve = mGroupsNoResolve;
+				notifyGroupsChanged();
+			}
+
 			inline constexpr bool hasGroup(Group mGroup) const noexcept				{ return groups[mGroup]; }
 			inline constexpr bool hasGroupToCheck(Group mGroup) const noexcept		{ return groupsToCheck[mGroup]; }
 			inline constexpr bool hasGroupNoResolve(Group mGroup) const noexcept	{ return groupsNoResolve[mGroup]; }
@@ -7,11 +7,16 @@
 
 namespace ssvsc
 {
+	// With grid spatial types (`Grid`, `HashGrid`), sensors are stored in their own per-cell lists: moving bodies find the sensors they overlap during
+	// their own detection, and sensors only look for what they overlap on frames they moved (or were created), so idle sensors cost nothing
+	// As a consequence, `onDetection` fires every frame for moving bodies, but only on those frames for static, sleeping or out of bounds bodies
+	// Other spatial types keep checking every sensor against the bodies it overlaps every frame, and never detect sensor pairs
 	template<typename TW> class Sensor : public Base<TW>
 	{
 		public:
 			using SpatialInfoType = typename TW::SpatialInfoType;
 			using DetectionInfoType = typename TW::DetectionInfoType;
+			using SensorDetectionInfoType = typename TW::SensorDetectionInfoType;
 			using ResolverType = typename TW::ResolverType;
 			using ResolverInfoType = typename TW::ResolverInfoType;
 			using ResolutionInfoType = typename TW::ResolutionInfoType;
@@ -23,23 +28,57 @@ namespace ssvsc
 
 		private:
 			AABB shape;
+			bool stepping{false}, detectingSensors{false};
 
-			inline void update(FT mFT)
+			// Sensors are stepped in two phases: `beginStep` runs before bodies are stepped, so that bodies find sensors where they are during
+			// this frame, and `detect` runs after them
+			inline void beginStep()
 			{
 				this->onPreUpdate();
-				if(this->outOfBounds) { this->outOfBounds = false; return; };
-				this->spatialInfo.template preUpdate<SensorTag>();
+				stepping = !this->outOfBounds;
+				this->outOfBounds = false;
+				if(stepping) this->spatialInfo.template preUpdate<SensorTag>();
+			}
+			inline void detect(FT mFT)
+			{
+				if(!stepping) return;
 				this->spatialInfo.template handleCollisions<SensorTag>(mFT);
-				this->spatialInfo.postUpdate();
+				this->spatialInfo.template postUpdate<SensorTag>();
 			}
 			inline void handleCollision(FT mFT, Body<TW>* mBody)
 			{
+				SSVSC_STATS_COUNT(this->world, candidatePairs, 1);
 				if(!this->mustCheck(*mBody) || !shape.isOverlapping(mBody->getShape())) return;
-				this->onDetection({*mBody, mBody->getUserData(), mFT});
+
+				SSVSC_STATS_COUNT(this->world, overlaps, 1);
+				this->dispatchDetection(*mBody, mFT);
+			}
+			inline void handleCollision(FT mFT, Sensor& mSensor)
+			{
+				SSVSC_STATS_COUNT(this->world, candidatePairs, 1);
+
+				const bool detects{detectingSensors && this->mustCheck(mSensor)}, detected{mSensor.detectingSensors && mSensor.mustCheck(*this)};
+				if((!detects && !detected) || !shape.isOverlapping(mSensor.shape)) return;
+
+				SSVSC_STATS_COUNT(this->world, overlaps, 1);
+				if(detects) dispatchSensorDetection(mSensor, mFT);
+				if(detected) mSensor.dispatchSensorDetection(*this, mFT);
+			}
+			inline void dispatchSensorDetection(Sensor& mSensor, FT mFT)
+			{
+				if(this->world.isDeferringEvents()) this->world.getEventBuffer().push(Impl::EventType::SensorDetection, *this, mSensor);
+				else onSensorDetection({mSensor, mFT});
 			}
 
 		public:
-			inline Sensor(TW& mWorld, const Vec2i& mPos, const Vec2i& mSize) noexcept : Base<TW>{mWorld}, shape{mPos, mSize / 2} { this->spatialInfo.template preUpdate<SensorTag>(); }
+			// Fires for the sensors this one checks (see `setDetectingSensors`), on frames where either of the two moved (or was created)
+			ssvu::Delegate<void(const SensorDetectionInfoType&)> onSensorDetection;
+
+			inline Sensor(TW& mWorld, const Vec2i& mPos, const Vec2i& mSize) noexcept : Base<TW>{mWorld}, shape{mPos, mSize / 2}
+			{
+				this->onGroupsChanged = [](Groupable& mX){ static_cast<Sensor&>(mX).spatialInfo.template refreshGroups<SensorTag>(); };
+				this->spatialInfo.template init<SensorTag>();
+			}
 			inline ~Sensor() noexcept { destroy(); }
 			inline void destroy() { this->spatialInfo.template destroy<SensorTag>(); this->world.delSensor(this); }
 
@@ -49,7 +88,11 @@ namespace ssvsc
 				shape.setPosition(mPos);
 			}
 
+			// Sensor pairs are opt-in, and only detected with grid spatial types: a detecting sensor gets `onSensorDetection` for every sensor it checks
+			inline void setDetectingSensors(bool mDetecting) noexcept { detectingSensors = mDetecting; }
+
 			inline AABB& getShape() noexcept { return shape; }
+			inline bool isDetectingSensors() const noexcept { return detectingSensors; }
 	};
 }
 
@@ -17,8 +17,9 @@ namespace ssvsc
 	constexpr SizeT maxGroups{32};
 	using Group = unsigned int;
 	using GroupBitset = std::bitset<maxGroups>;
+	using BodyHandle = SizeT;
 
-	enum class QueryType{Point, Distance, RayCast, OrthoLeft, OrthoRight, OrthoUp, OrthoDown};
+	enum class QueryType{Point, Distance, RayCast, OrthoLeft, OrthoRight, OrthoUp, OrthoDown, Region};
 	enum class QueryMode{All, ByGroup};
 
 	struct BodyTag { };
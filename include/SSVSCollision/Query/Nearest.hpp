@@ -0,0 +1,73 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_QUERY_NEAREST
+#define SSVSC_QUERY_NEAREST
+
+namespace ssvsc
+{
+	template<typename TW> class Body;
+
+	// `distance` is measured from the query point to the closest point of the body's shape (zero if the point is inside it)
+	template<typename TW> struct NearestHit
+	{
+		Body<TW>* body;
+		float distance;
+	};
+
+	namespace Impl
+	{
+		inline float getDistSquared(const AABB& mShape, const Vec2f& mPoint) noexcept
+		{
+			const float dx{std::max({mShape.getLeft() - mPoint.x, 0.f, mPoint.x - mShape.getRight()})};
+			const float dy{std::max({mShape.getTop() - mPoint.y, 0.f, mPoint.y - mShape.getBottom()})};
+			return dx * dx + dy * dy;
+		}
+
+		// Keeps the `k` closest bodies seen so far in a max-heap stored directly in the output vector (holding squared distances until `finish`)
+		// Equal distances are ordered by handle, so that results never depend on traversal order
+		template<typename TW> class NearestHeap
+		{
+			private:
+				std::vector<NearestHit<TW>>& hits;
+				SizeT k;
+				float maxDistSquared;
+
+				inline static bool isCloser(const NearestHit<TW>& mA, const NearestHit<TW>& mB) noexcept
+				{
+					return mA.distance < mB.distance || (mA.distance == mB.distance && mA.body->getHandle() < mB.body->getHandle());
+				}
+
+			public:
+				inline NearestHeap(std::vector<NearestHit<TW>>& mHits, SizeT mK, float mMaxDist) : hits(mHits), k{mK}, maxDistSquared{mMaxDist * mMaxDist}
+				{
+					hits.clear();
+				}
+
+				// Candidates farther than this cannot enter the heap anymore
+				inline float getBoundSquared() const noexcept { return hits.size() < k ? maxDistSquared : hits.front().distance; }
+
+				inline void add(Body<TW>& mBody, float mDistSquared)
+				{
+					if(k == 0 || mDistSquared > maxDistSquared) return;
+
+					const NearestHit<TW> hit{&mBody, mDistSquared};
+					if(hits.size() < k) { hits.emplace_back(hit); std::push_heap(std::begin(hits), std::end(hits), isCloser); return; }
+					if(!isCloser(hit, hits.front())) return;
+
+					std::pop_heap(std::begin(hits), std::end(hits), isCloser);
+					hits.back() = hit;
+					std::push_heap(std::begin(hits), std::end(hits), isCloser);
+				}
+
+				inline void finish()
+				{
+					std::sort_heap(std::begin(hits), std::end(hits), isCloser);
+					for(auto& h : hits) h.distance = std::sqrt(h.distance);
+				}
+		};
+	}
+}
+
+#endif
@@ -12,6 +12,37 @@ namespace ssvsc
 	template<typename TW, typename TS, QueryType TType> struct QueryTypeDispatcher;
 	template<typename TW, typename TS, QueryMode TMode> struct QueryModeDispatcher;
 
+	namespace Impl
+	{
+		// Body buffers are recycled through a per-thread pool: a query takes one on construction and gives it back (with its capacity) on destruction,
+		// so that once the pool is warm, running queries does not allocate
+		template<typename TW> class QueryBuffers
+		{
+			private:
+				std::vector<std::vector<Body<TW>*>> pool;
+
+				inline static auto& get() { thread_local QueryBuffers buffers; return buffers.pool; }
+
+			public:
+				inline static std::vector<Body<TW>*> acquire()
+				{
+					auto& pool(get());
+					if(pool.empty()) return {};
+
+					auto result(std::move(pool.back()));
+					pool.pop_back();
+					return result;
+				}
+				inline static void release(std::vector<Body<TW>*>&& mBuffer)
+				{
+					if(mBuffer.capacity() == 0) return;
+
+					mBuffer.clear();
+					get().emplace_back(std::move(mBuffer));
+				}
+		};
+	}
+
 	template<typename TW, typename TInternal, typename TMode> class Query
 	{
 		public:
@@ -19,24 +50,28 @@ namespace ssvsc
 			friend TInternal;
 
 		private:
-			std::vector<BodyType*> bodies;
+			std::vector<BodyType*> bodies{Impl::QueryBuffers<TW>::acquire()};
 			TInternal internal;
 
 		public:
-			template<typename... TArgs> inline Query(TArgs&&... mArgs) noexcept : internal{FWD(mArgs)...} { }
+			template<typename... TArgs> inline Query(TArgs&&... mArgs) : internal{FWD(mArgs)...} { }
+			inline Query(Query&&) = default;
+			inline ~Query() { Impl::QueryBuffers<TW>::release(std::move(bodies)); }
 			template<typename... TArgs> BodyType* next(TArgs&&... mArgs)
 			{
-				while(internal.isValid())
+				while(true)
 				{
 					// If the body stack is empty, 'refill' it using TMode::getBodies, then sort
 					if(bodies.empty())
 					{
+						if(!internal.isValid()) return nullptr;
+
 						TMode::getBodies(bodies, internal, FWD(mArgs)...);
 						ssvu::sort(bodies, [this](const BodyType* mA, const BodyType* mB){ return internal.getSorting(mA, mB); });
 						internal.step();
 					}
 
-					// While the body stack is not empty, 'yield' bodies one by one
+					// While the body stack is not empty, 'yield' bodies one by one (even if the last step made the query invalid)
 					while(!bodies.empty())
 					{
 						BodyType* body{bodies.back()};
@@ -49,8 +84,6 @@ namespace ssvsc
 						return body;
 					}
 				}
-
-				return nullptr;
 			}
 
 			inline void reset() { bodies.clear(); internal.reset(); }
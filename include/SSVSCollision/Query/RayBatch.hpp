@@ -0,0 +1,169 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_QUERY_RAYBATCH
+#define SSVSC_QUERY_RAYBATCH
+
+namespace ssvsc
+{
+	template<typename TW> class Body;
+
+	// `dir` does not need to be normalized: hit distances are always euclidean distances from `origin`
+	struct Ray
+	{
+		Vec2f origin, dir;
+		float maxDist{ssvu::NumLimits<float>::max()};
+	};
+
+	template<typename TW> struct RayHit
+	{
+		Body<TW>* body{nullptr};
+		float distance{0};
+		Vec2f point;
+
+		inline explicit operator bool() const noexcept { return body != nullptr; }
+	};
+
+	namespace Impl
+	{
+		// Per-thread scratch reused by every batch: bodies are stamped with the current ray's epoch the first time they are tested, so that bodies spanning
+		// several cells are only tested once per ray
+		struct RayBatchScratch
+		{
+			std::vector<std::uint32_t> stamps;
+			struct PacketEntry { int y, x; SizeT ray; };
+			std::vector<PacketEntry> order;
+			std::uint32_t epoch{0};
+
+			inline void beginRay(SizeT mBodyCount)
+			{
+				if(stamps.size() < mBodyCount) stamps.resize(mBodyCount, 0);
+				if(++epoch != 0) return;
+
+				std::fill(std::begin(stamps), std::end(stamps), 0);
+				epoch = 1;
+			}
+			inline bool stamp(SizeT mIdx) noexcept
+			{
+				if(stamps[mIdx] == epoch) return false;
+				stamps[mIdx] = epoch;
+				return true;
+			}
+
+			inline static RayBatchScratch& get() { thread_local RayBatchScratch scratch; return scratch; }
+		};
+
+		// Slab test against a closed AABB; `mDir` must be normalized
+		inline bool getRayEntry(const AABB& mShape, const Vec2f& mOrigin, const Vec2f& mDir, float& mT) noexcept
+		{
+			auto tMin(-ssvu::NumLimits<float>::max()), tMax(ssvu::NumLimits<float>::max());
+
+			auto slab([&tMin, &tMax](float mOrigin, float mDir, float mMin, float mMax)
+			{
+				if(mDir == 0) return mOrigin >= mMin && mOrigin <= mMax;
+
+				auto t1((mMin - mOrigin) / mDir), t2((mMax - mOrigin) / mDir);
+				if(t1 > t2) std::swap(t1, t2);
+				tMin = std::max(tMin, t1);
+				tMax = std::min(tMax, t2);
+				return tMin <= tMax;
+			});
+
+			if(!slab(mOrigin.x, mDir.x, mShape.getLeft(), mShape.getRight()) || !slab(mOrigin.y, mDir.y, mShape.getTop(), mShape.getBottom()) || tMax < 0) return false;
+
+			mT = std::max(tMin, 0.f);
+			return true;
+		}
+
+		// Grids bin coordinates by truncating division, so cell 0 spans both sides of the origin: the traversal walks uniform
+		// (floored) cells and maps them to grid cells, skipping consecutive repeats
+		inline int getGridIdxFromFloored(int mIdx) noexcept { return mIdx < 0 ? mIdx + 1 : mIdx; }
+
+		// Walks the cells crossed by the ray in order (Amanatides-Woo), testing every body once, and stops as soon as the closest hit
+		// found so far lies before the exit of the current cell; rays starting outside of the grid hit nothing
+		template<typename TW, typename TGrid, typename TStore, typename TF> inline RayHit<TW> castRay(const TGrid& mGrid, const TStore& mStore,
+			RayBatchScratch& mScratch, const Ray& mRay, TF mFilter)
+		{
+			RayHit<TW> result;
+
+			const auto length(std::sqrt(mRay.dir.x * mRay.dir.x + mRay.dir.y * mRay.dir.y));
+			if(length == 0) return result;
+
+			const Vec2f dir{mRay.dir / length};
+			const auto cellSize(ssvu::toFloat(mGrid.getCellSize()));
+			const auto inf(ssvu::NumLimits<float>::max());
+
+			mScratch.beginRay(mStore.getSize());
+
+			int cX{static_cast<int>(std::floor(mRay.origin.x / cellSize))}, cY{static_cast<int>(std::floor(mRay.origin.y / cellSize))};
+			const int stepX{dir.x > 0 ? 1 : dir.x < 0 ? -1 : 0}, stepY{dir.y > 0 ? 1 : dir.y < 0 ? -1 : 0};
+			const float deltaX{stepX != 0 ? cellSize / std::abs(dir.x) : inf}, deltaY{stepY != 0 ? cellSize / std::abs(dir.y) : inf};
+			float maxX{stepX > 0 ? ((cX + 1) * cellSize - mRay.origin.x) / dir.x : stepX < 0 ? (cX * cellSize - mRay.origin.x) / dir.x : inf};
+			float maxY{stepY > 0 ? ((cY + 1) * cellSize - mRay.origin.y) / dir.y : stepY < 0 ? (cY * cellSize - mRay.origin.y) / dir.y : inf};
+
+			auto best(mRay.maxDist);
+			Vec2i lastIdx{ssvu::NumLimits<int>::max(), ssvu::NumLimits<int>::max()};
+
+			while(true)
+			{
+				const Vec2i idx{getGridIdxFromFloored(cX), getGridIdxFromFloored(cY)};
+				if(!mGrid.isIdxValid(idx)) break;
+
+				if(idx != lastIdx)
+				{
+					lastIdx = idx;
+					mGrid.forEachBodyAt(idx, [&](Body<TW>* mBody)
+					{
+						if(!mScratch.stamp(mStore.getIdx(mBody->getHandle())) || !mFilter(*mBody)) return;
+
+						float t;
+						if(!getRayEntry(mBody->getShape(), mRay.origin, dir, t) || t > best) return;
+
+						// Ties are broken by handle, so that results do not depend on cell iteration order
+						if(t == best && result.body != nullptr && result.body->getHandle() < mBody->getHandle()) return;
+
+						best = t;
+						result.body = mBody;
+					});
+				}
+
+				const auto cellExit(std::min(maxX, maxY));
+				if((result.body != nullptr && best <= cellExit) || cellExit > mRay.maxDist) break;
+
+				if(maxX < maxY)	{ maxX += deltaX; cX += stepX; }
+				else			{ maxY += deltaY; cY += stepY; }
+			}
+
+			if(result.body != nullptr)
+			{
+				result.distance = best;
+				result.point = mRay.origin + dir * best;
+			}
+
+			return result;
+		}
+
+		// Rays are processed in packets of consecutive rays (one job each when threads are available), and walked in order of starting cell inside
+		// a packet, so that neighbouring rays reuse the cells and bodies still in cache
+		template<typename TW, typename TGrid, typename TStore, typename TF> inline void castRayPacket(const TGrid& mGrid, const TStore& mStore,
+			const Ray* mRays, RayHit<TW>* mHits, SizeT mBegin, SizeT mEnd, TF& mFilter)
+		{
+			auto& scratch(RayBatchScratch::get());
+
+			scratch.order.clear();
+			for(auto i(mBegin); i < mEnd; ++i)
+			{
+				const auto idx(mGrid.getIdx(Vec2i(mRays[i].origin)));
+				scratch.order.push_back({idx.y, idx.x, i});
+			}
+			ssvu::sort(scratch.order, [](const RayBatchScratch::PacketEntry& mA, const RayBatchScratch::PacketEntry& mB){ return std::tie(mA.y, mA.x, mA.ray) < std::tie(mB.y, mB.x, mB.ray); });
+
+			for(const auto& o : scratch.order) mHits[o.ray] = castRay<TW>(mGrid, mStore, scratch, mRays[o.ray], mFilter);
+		}
+
+		constexpr SizeT rayPacketSize{64};
+	}
+}
+
+#endif
@@ -21,15 +21,40 @@ namespace ssvsc
 			inline auto& getBody() noexcept { return ssvu::castUp<BodyType>(*this); }
 			inline const auto& getBody() const noexcept { return ssvu::castUp<BodyType>(*this); }
 
+			inline void writeState(Impl::BlobWriter& mWriter) const
+			{
+				mWriter.write(velTransferMult);
+				mWriter.write(velTransferImpulse);
+				mWriter.write(stress);
+				mWriter.write(nextStress);
+				mWriter.write(stressMult);
+				mWriter.write(stressPropagationMult);
+			}
+			inline void readState(Impl::BlobReader& mReader)
+			{
+				velTransferMult = mReader.read<Vec2f>();
+				velTransferImpulse = mReader.read<Vec2f>();
+				stress = mReader.read<Vec2f>();
+				nextStress = mReader.read<Vec2f>();
+				stressMult = mReader.read<float>();
+				stressPropagationMult = mReader.read<float>();
+			}
+
 		public:
 			inline void applyImpulse(const Vec2f& mImpulse) noexcept
 			{
+				// Static bodies are shared between contact islands, so they must never be written to during resolution
+				// Sleeping bodies are left alone as well: only bodies moving fast enough to wake them up should push them
+				if(getBody().isStatic() || getBody().isAsleep()) return;
+
 				const auto& vel(getBody().getVelocity());
 				getBody().setVelocityX(vel.x + getBody().getInvMass() * (mImpulse.x / (1.f + (stress.y * stressPropagationMult))));
 				getBody().setVelocityY(vel.y + getBody().getInvMass() * (mImpulse.y / (1.f + (stress.x * stressPropagationMult))));
 			}
 			inline void applyStress(const Vec2f& mStress) noexcept
 			{
+				if(getBody().isStatic() || getBody().isAsleep()) return;
+
 				const auto& newStress(nextStress + ssvs::getAbs(getBody().getInvMass() * mStress * stressMult));
 
 				// If the operation would result in an overflow, return
@@ -70,6 +95,9 @@ namespace ssvsc
 
 			for(const auto& b : mToResolve)
 			{
+				// Entries queued by another body's detection may no longer overlap
+				if(!shape.isOverlapping(b->getShape())) continue;
+
 				int iX{Utils::getMinIntersectionX(shape, b->getShape())}, iY{Utils::getMinIntersectionY(shape, b->getShape())};
 
 				if(std::abs(iX) < std::abs(iY))
@@ -93,7 +121,7 @@ namespace ssvsc
 				bool noResolvePosition{false}, noResolveVelocity{false};
 				Vec2i resolution{std::abs(iX) < std::abs(iY) ? Vec2i{iX, 0} : Vec2i{0, iY}};
 
-				mBody.onResolution({*b, b->getUserData(), resolution, noResolvePosition, noResolveVelocity});
+				mBody.dispatchResolution(*b, resolution, noResolvePosition, noResolveVelocity);
 
 				if(!noResolvePosition) mBody.resolvePosition(resolution);
 				if(noResolveVelocity) continue;
@@ -17,6 +17,10 @@ namespace ssvsc
 		protected:
 			inline auto& getBody() noexcept { return ssvu::castUp<BodyType>(*this); }
 			inline const auto& getBody() const noexcept { return ssvu::castUp<BodyType>(*this); }
+
+			// `Retro` keeps no per-body state
+			inline void writeState(Impl::BlobWriter&) const noexcept { }
+			inline void readState(Impl::BlobReader&) noexcept { }
 	};
 
 	template<typename TW> struct Retro
@@ -38,7 +42,7 @@ namespace ssvsc
 				int iX{Utils::getMinIntersectionX(shape, s)}, iY{Utils::getMinIntersectionY(shape, s)};
 				Vec2i resolution{std::abs(iX) < std::abs(iY) ? Vec2i{iX, 0} : Vec2i{0, iY}};
 				bool noResolvePosition{false}, noResolveVelocity{false};
-				mBody.onResolution({*b, b->getUserData(), resolution, noResolvePosition, noResolveVelocity});
+				mBody.dispatchResolution(*b, resolution, noResolvePosition, noResolveVelocity);
 
 				if(!noResolvePosition) mBody.resolvePosition(resolution);
 				if(noResolveVelocity) continue;
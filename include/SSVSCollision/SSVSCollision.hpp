@@ -6,18 +6,46 @@
 #define SSVSCOLLISION
 
 #include <queue>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <array>
+#include <tuple>
+#include <ostream>
 #include <SSVUtils/SSVUtils.hpp>
 #include <SSVStart/SSVStart.hpp>
 #include "SSVSCollision/Global/Typedefs.hpp"
 #include "SSVSCollision/Utils/Segment.hpp"
 #include "SSVSCollision/Utils/Utils.hpp"
+#include "SSVSCollision/Utils/PagedVector.hpp"
+#include "SSVSCollision/Utils/FlatHashMap.hpp"
+#include "SSVSCollision/Utils/ThreadPool.hpp"
+#include "SSVSCollision/Utils/Islands.hpp"
+#include "SSVSCollision/Utils/Stats.hpp"
 #include "SSVSCollision/AABB/AABB.hpp"
+#include "SSVSCollision/Utils/UtilsAABB.hpp"
+#include "SSVSCollision/Utils/OverlapKernel.hpp"
+#include "SSVSCollision/Utils/Blob.hpp"
+#include "SSVSCollision/Utils/MappedFile.hpp"
+#include "SSVSCollision/World/EventBuffer.hpp"
+#include "SSVSCollision/World/ContactCache.hpp"
 #include "SSVSCollision/Body/Body.hpp"
 #include "SSVSCollision/Query/Query.hpp"
+#include "SSVSCollision/Query/RayBatch.hpp"
+#include "SSVSCollision/Query/Nearest.hpp"
 #include "SSVSCollision/World/World.hpp"
-#include "SSVSCollision/Utils/UtilsAABB.hpp"
+#include "SSVSCollision/World/TileLayer.hpp"
 #include "SSVSCollision/Resolver/Resolver.hpp"
 #include "SSVSCollision/Spatial/Grid/Grid.hpp"
+#include "SSVSCollision/World/ChunkStreamer.hpp"
+#include "SSVSCollision/Spatial/SweepAndPrune/SweepAndPrune.hpp"
+#include "SSVSCollision/Spatial/AABBTree/AABBTree.hpp"
+#include "SSVSCollision/Spatial/RebuildGrid/RebuildGrid.hpp"
 #include "SSVSCollision/Query/Query.hpp"
 
 #endif
@@ -0,0 +1,288 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_AABBTREE
+#define SSVSC_SPATIAL_AABBTREE
+
+#include "SSVSCollision/Spatial/AABBTree/AABBTreeInfo.hpp"
+
+namespace ssvsc
+{
+	namespace Impl
+	{
+		// Edge-based box used by the tree nodes: merging never loses a pixel to halfSize rounding
+		struct TreeBox
+		{
+			int left, right, top, bottom;
+
+			inline TreeBox() = default;
+			inline TreeBox(int mLeft, int mRight, int mTop, int mBottom) noexcept : left{mLeft}, right{mRight}, top{mTop}, bottom{mBottom} { }
+			inline TreeBox(const AABB& mX, int mMargin = 0) noexcept : left{mX.getLeft() - mMargin}, right{mX.getRight() + mMargin}, top{mX.getTop() - mMargin}, bottom{mX.getBottom() + mMargin} { }
+
+			inline static TreeBox getMerged(const TreeBox& mA, const TreeBox& mB) noexcept
+			{
+				return {std::min(mA.left, mB.left), std::max(mA.right, mB.right), std::min(mA.top, mB.top), std::max(mA.bottom, mB.bottom)};
+			}
+
+			inline long long getPerimeter() const noexcept { return 2ll * ((right - left) + (bottom - top)); }
+
+			inline bool contains(const AABB& mX) const noexcept		{ return mX.getLeft() >= left && mX.getRight() <= right && mX.getTop() >= top && mX.getBottom() <= bottom; }
+			inline bool contains(const Vec2i& mX) const noexcept	{ return mX.x >= left && mX.x < right && mX.y >= top && mX.y < bottom; }
+			inline bool isOverlapping(const AABB& mX) const noexcept { return mX.getRight() > left && mX.getLeft() < right && mX.getBottom() > top && mX.getTop() < bottom; }
+			inline float getDistSquared(const Vec2f& mX) const noexcept
+			{
+				const float dx{std::max({left - mX.x, 0.f, mX.x - right})}, dy{std::max({top - mX.y, 0.f, mX.y - bottom})};
+				return dx * dx + dy * dy;
+			}
+
+			// Slab test: returns the parametric [entry, exit] range of `mStart + mDir * t` inside the box
+			inline bool getRayRange(const Vec2f& mStart, const Vec2f& mDir, float& mTMin, float& mTMax) const noexcept
+			{
+				const float mins[2]{toFloat(left), toFloat(top)}, maxs[2]{toFloat(right), toFloat(bottom)};
+				const float starts[2]{mStart.x, mStart.y}, dirs[2]{mDir.x, mDir.y};
+
+				for(int a{0}; a < 2; ++a)
+				{
+					if(dirs[a] == 0) { if(starts[a] < mins[a] || starts[a] > maxs[a]) return false; continue; }
+
+					float t1{(mins[a] - starts[a]) / dirs[a]}, t2{(maxs[a] - starts[a]) / dirs[a]};
+					if(t1 > t2) std::swap(t1, t2);
+					mTMin = std::max(mTMin, t1);
+					mTMax = std::min(mTMax, t2);
+					if(mTMin > mTMax) return false;
+				}
+
+				return true;
+			}
+
+			inline static float toFloat(int mX) noexcept { return static_cast<float>(mX); }
+		};
+	}
+
+	// Dynamic bounding volume hierarchy: leaves store "fat" boxes enlarged by a margin, so that a body
+	// is only reinserted once it leaves its fat box; the tree is kept balanced with AVL-style rotations
+	template<typename TW> class AABBTree
+	{
+		public:
+			using SpatialInfoType = AABBTreeInfo<TW>;
+			using BodyType = Body<TW>;
+			friend SpatialInfoType;
+
+			static constexpr int nullNode{-1};
+
+			struct Node
+			{
+				Impl::TreeBox box;
+				SpatialInfoType* owner{nullptr};
+				int parent{nullNode}, left{nullNode}, right{nullNode}, height{0};
+
+				inline bool isLeaf() const noexcept { return left == nullNode; }
+			};
+
+		private:
+			std::vector<Node> nodes;
+			int root{nullNode}, freeList{nullNode}, fatMargin;
+
+			inline int allocateNode()
+			{
+				if(freeList == nullNode) { nodes.emplace_back(); return static_cast<int>(nodes.size() - 1); }
+
+				const int result{freeList};
+				freeList = nodes[result].parent;
+				nodes[result] = Node{};
+				return result;
+			}
+			inline void freeNode(int mNode) noexcept
+			{
+				nodes[mNode].parent = freeList;
+				nodes[mNode].height = -1;
+				freeList = mNode;
+			}
+
+			inline void refit(int mNode) noexcept
+			{
+				auto& n(nodes[mNode]);
+				n.height = 1 + std::max(nodes[n.left].height, nodes[n.right].height);
+				n.box = Impl::TreeBox::getMerged(nodes[n.left].box, nodes[n.right].box);
+			}
+			inline void replaceChild(int mParent, int mOld, int mNew) noexcept
+			{
+				if(mParent == nullNode) { root = mNew; return; }
+				auto& p(nodes[mParent]);
+				(p.left == mOld ? p.left : p.right) = mNew;
+			}
+
+			// Rotates the taller grandchild up if `mA` is unbalanced, returning the new subtree root
+			inline int balance(int mA) noexcept
+			{
+				auto& a(nodes[mA]);
+				if(a.isLeaf() || a.height < 2) return mA;
+
+				const int iB{a.left}, iC{a.right};
+				const int diff{nodes[iC].height - nodes[iB].height};
+
+				if(diff > 1) return rotateUp(mA, iC, false);
+				if(diff < -1) return rotateUp(mA, iB, true);
+				return mA;
+			}
+			inline int rotateUp(int mA, int mUp, bool mUpIsLeft) noexcept
+			{
+				auto& a(nodes[mA]);
+				auto& up(nodes[mUp]);
+				const int iF{up.left}, iG{up.right};
+
+				up.left = mA;
+				up.parent = a.parent;
+				a.parent = mUp;
+				replaceChild(up.parent, mA, mUp);
+
+				// The taller grandchild stays under `up`, the other one replaces `up` under `a`
+				const bool fTaller{nodes[iF].height > nodes[iG].height};
+				const int iKeep{fTaller ? iF : iG}, iMove{fTaller ? iG : iF};
+
+				up.right = iKeep;
+				(mUpIsLeft ? a.left : a.right) = iMove;
+				nodes[iMove].parent = mA;
+
+				refit(mA);
+				refit(mUp);
+				return mUp;
+			}
+
+			inline void insertLeaf(int mLeaf)
+			{
+				if(root == nullNode) { root = mLeaf; nodes[root].parent = nullNode; return; }
+
+				// Descend choosing the child with the lowest perimeter cost increase
+				const auto leafBox(nodes[mLeaf].box);
+				int idx{root};
+
+				while(!nodes[idx].isLeaf())
+				{
+					const auto& n(nodes[idx]);
+					const auto perimeter(n.box.getPerimeter()), combined(Impl::TreeBox::getMerged(n.box, leafBox).getPerimeter());
+					const auto cost(2 * combined), inheritance(2 * (combined - perimeter));
+
+					const auto getChildCost([&](int mChild)
+					{
+						const auto& c(nodes[mChild]);
+						const auto merged(Impl::TreeBox::getMerged(c.box, leafBox).getPerimeter());
+						return (c.isLeaf() ? merged : merged - c.box.getPerimeter()) + inheritance;
+					});
+
+					const auto costLeft(getChildCost(n.left)), costRight(getChildCost(n.right));
+					if(cost < costLeft && cost < costRight) break;
+					idx = costLeft < costRight ? n.left : n.right;
+				}
+
+				const int sibling{idx}, oldParent{nodes[sibling].parent}, newParent{allocateNode()};
+
+				auto& p(nodes[newParent]);
+				p.parent = oldParent;
+				p.left = sibling;
+				p.right = mLeaf;
+				nodes[sibling].parent = newParent;
+				nodes[mLeaf].parent = newParent;
+				replaceChild(oldParent, sibling, newParent);
+
+				for(int i{newParent}; i != nullNode; i = nodes[i].parent) { i = balance(i); refit(i); }
+			}
+			inline void removeLeaf(int mLeaf)
+			{
+				if(mLeaf == root) { root = nullNode; return; }
+
+				const int parent{nodes[mLeaf].parent}, grandParent{nodes[parent].parent};
+				const int sibling{nodes[parent].left == mLeaf ? nodes[parent].right : nodes[parent].left};
+
+				replaceChild(grandParent, parent, sibling);
+				nodes[sibling].parent = grandParent;
+				freeNode(parent);
+
+				for(int i{grandParent}; i != nullNode; i = nodes[i].parent) { i = balance(i); refit(i); }
+			}
+
+			inline int insert(SpatialInfoType& mOwner, const AABB& mShape)
+			{
+				const int leaf{allocateNode()};
+				auto& n(nodes[leaf]);
+				n.box = Impl::TreeBox{mShape, fatMargin};
+				n.owner = &mOwner;
+
+				insertLeaf(leaf);
+				return leaf;
+			}
+			inline void remove(int mLeaf) { removeLeaf(mLeaf); freeNode(mLeaf); }
+
+		public:
+			inline AABBTree(int mFatMargin = 8) noexcept : fatMargin{mFatMargin} { }
+
+			// Visits every leaf whose fat box passes `mTest`, pruning subtrees that fail it
+			template<typename TTest, typename TF> inline void forEachLeaf(const TTest& mTest, const TF& mFn) const
+			{
+				if(root == nullNode) return;
+
+				constexpr SizeT maxDepth{256};
+				int stack[maxDepth];
+				SizeT size{0};
+				stack[size++] = root;
+
+				while(size > 0)
+				{
+					const auto& n(nodes[stack[--size]]);
+					if(!mTest(n.box)) continue;
+
+					if(n.isLeaf()) { mFn(*n.owner); continue; }
+
+					SSVU_ASSERT(size + 2 <= maxDepth);
+					stack[size++] = n.left;
+					stack[size++] = n.right;
+				}
+			}
+
+			template<typename TFilter, typename TF> inline void forEachOverlapping(const AABB& mRegion, const TFilter& mFilter, const TF& mFn) const
+			{
+				forEachLeaf([&mRegion](const Impl::TreeBox& mBox){ return mBox.isOverlapping(mRegion); }, [&](const SpatialInfoType& mInfo)
+				{
+					auto& body(ssvu::castUp<BodyType>(mInfo.getBase()));
+					if(mFilter(body) && body.getShape().isOverlapping(mRegion)) mFn(body);
+				});
+			}
+
+			// Depth-first, pruning subtrees farther than `mGetBoundSquared()`, which may shrink during the traversal
+			template<typename TBound, typename TFilter, typename TF> inline void forEachNear(const Vec2f& mPos, const TBound& mGetBoundSquared, const TFilter& mFilter, const TF& mFn) const
+			{
+				forEachLeaf([&](const Impl::TreeBox& mBox){ return mBox.getDistSquared(mPos) <= mGetBoundSquared(); }, [&](const SpatialInfoType& mInfo)
+				{
+					auto& body(ssvu::castUp<BodyType>(mInfo.getBase()));
+					if(mFilter(body)) mFn(body);
+				});
+			}
+
+			inline const Impl::TreeBox* getBounds() const noexcept	{ return root == nullNode ? nullptr : &nodes[root].box; }
+			inline int getHeight() const noexcept					{ return root == nullNode ? 0 : nodes[root].height; }
+			inline int getFatMargin() const noexcept				{ return fatMargin; }
+			inline const auto& getNodes() const noexcept			{ return nodes; }
+	};
+
+	namespace AABBTreeQueryTypes
+	{
+		template<typename TW> struct Point;
+		template<typename TW> struct Distance;
+		template<typename TW> struct RayCast;
+		template<typename TW> struct Region;
+		namespace Bodies { template<typename TW> struct All; template<typename TW> struct ByGroup; }
+	}
+
+	template<typename TW> struct QueryTypeDispatcher<TW, AABBTree<TW>, QueryType::Point>	{ using Type = AABBTreeQueryTypes::Point<TW>; };
+	template<typename TW> struct QueryTypeDispatcher<TW, AABBTree<TW>, QueryType::Distance>	{ using Type = AABBTreeQueryTypes::Distance<TW>; };
+	template<typename TW> struct QueryTypeDispatcher<TW, AABBTree<TW>, QueryType::RayCast>	{ using Type = AABBTreeQueryTypes::RayCast<TW>; };
+	template<typename TW> struct QueryTypeDispatcher<TW, AABBTree<TW>, QueryType::Region>	{ using Type = AABBTreeQueryTypes::Region<TW>; };
+
+	template<typename TW> struct QueryModeDispatcher<TW, AABBTree<TW>, QueryMode::All>		{ using Type = AABBTreeQueryTypes::Bodies::All<TW>; };
+	template<typename TW> struct QueryModeDispatcher<TW, AABBTree<TW>, QueryMode::ByGroup>	{ using Type = AABBTreeQueryTypes::Bodies::ByGroup<TW>; };
+}
+
+#include "SSVSCollision/Spatial/AABBTree/AABBTreeQueryTypes.hpp"
+
+#endif
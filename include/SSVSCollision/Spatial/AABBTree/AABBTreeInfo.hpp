@@ -0,0 +1,73 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_AABBTREEINFO
+#define SSVSC_SPATIAL_AABBTREEINFO
+
+namespace ssvsc
+{
+	template<typename TW> class AABBTreeInfo
+	{
+		public:
+			using SpatialType = typename TW::SpatialType;
+			using BaseType = Base<TW>;
+			using BodyType = Body<TW>;
+			using SensorType = Sensor<TW>;
+			friend SpatialType;
+
+		private:
+			SpatialType& tree;
+			BaseType& base;
+			int leaf{SpatialType::nullNode};
+
+			inline const AABB& getShapeImpl(BodyTag) const noexcept		{ return ssvu::castUp<BodyType>(base).getShape(); }
+			inline const AABB& getShapeImpl(SensorTag) const noexcept	{ return ssvu::castUp<SensorType>(base).getShape(); }
+			inline void handleCollisionImpl(FT mFT, BodyType* mBody, BodyTag) const noexcept	{ SSVU_ASSERT(mBody != nullptr); ssvu::castUp<BodyType>(base).handleCollision(mFT, mBody); }
+			inline void handleCollisionImpl(FT mFT, BodyType* mBody, SensorTag) const noexcept	{ SSVU_ASSERT(mBody != nullptr); ssvu::castUp<SensorType>(base).handleCollision(mFT, mBody); }
+
+			// Only bodies are stored as leaves: sensors query the tree from their own shape
+			inline void updateLeaf(BodyTag)
+			{
+				const auto& shape(getShapeImpl(BodyTag{}));
+
+				if(leaf != SpatialType::nullNode)
+				{
+					if(tree.nodes[leaf].box.contains(shape)) return;
+					tree.remove(leaf);
+				}
+
+				leaf = tree.insert(*this, shape);
+			}
+			inline void updateLeaf(SensorTag) noexcept { }
+
+		public:
+			inline AABBTreeInfo(SpatialType& mTree, BaseType& mBase) noexcept : tree(mTree), base(mBase) { }
+
+			template<typename TTag> inline void init()		{ updateLeaf(TTag{}); }
+			inline void invalidate() noexcept				{ }
+			template<typename TTag> inline void preUpdate()	{ updateLeaf(TTag{}); }
+			template<typename TTag> inline void postUpdate() const noexcept	{ }
+			template<typename TTag> inline void refreshGroups() const noexcept	{ }
+			template<typename TTag> inline void destroy()
+			{
+				if(leaf == SpatialType::nullNode) return;
+
+				tree.remove(leaf);
+				leaf = SpatialType::nullNode;
+			}
+			template<typename TTag> inline void handleCollisions(FT mFT)
+			{
+				const auto& shape(getShapeImpl(TTag{}));
+				tree.forEachLeaf([&shape](const auto& mBox){ return mBox.isOverlapping(shape); }, [this, mFT](AABBTreeInfo& mInfo)
+				{
+					handleCollisionImpl(mFT, &ssvu::castUp<BodyType>(mInfo.base), TTag{});
+				});
+			}
+
+			inline BaseType& getBase() const noexcept	{ return base; }
+			inline int getLeaf() const noexcept			{ return leaf; }
+	};
+}
+
+#endif
@@ -0,0 +1,146 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_AABBTREEQUERYTYPES
+#define SSVSC_SPATIAL_AABBTREEQUERYTYPES
+
+namespace ssvsc
+{
+	namespace AABBTreeQueryTypes
+	{
+		// Tree queries gather all their candidates in a single traversal, then yield them through the usual Query sorting
+		template<typename TW> struct Base
+		{
+			using TreeType = AABBTree<TW>;
+			using BodyType = Body<TW>;
+
+			const TreeType& tree;
+			Vec2f startPos, lastPos;
+			bool finished{false};
+
+			Base(const TreeType& mTree, const Vec2i& mPos) : tree(mTree), startPos{mPos} { }
+
+			inline bool isValid() const noexcept			{ return !finished; }
+			inline void step() noexcept						{ finished = true; }
+			inline void reset() noexcept					{ finished = false; }
+			inline const auto& getLastPos() const noexcept	{ return lastPos; }
+
+			template<typename TTest, typename TF> inline void forEachLeafBody(const TTest& mTest, const TF& mFn) const
+			{
+				tree.forEachLeaf(mTest, [&mFn](const AABBTreeInfo<TW>& mInfo){ mFn(&ssvu::castUp<BodyType>(mInfo.getBase())); });
+			}
+			inline bool sortByDistance(const BodyType* mA, const BodyType* mB) const
+			{
+				return ssvs::getDistEuclidean(mA->getPosition(), startPos) > ssvs::getDistEuclidean(mB->getPosition(), startPos);
+			}
+		};
+
+		namespace Bodies
+		{
+			template<typename TW> struct All
+			{
+				template<typename T> inline static void getBodies(std::vector<Body<TW>*>& mBodies, const T& mInternal)
+				{
+					mInternal.forEachCandidate([&mBodies](Body<TW>* mBody){ mBodies.emplace_back(mBody); });
+				}
+			};
+			template<typename TW> struct ByGroup
+			{
+				template<typename T> inline static void getBodies(std::vector<Body<TW>*>& mBodies, const T& mInternal, Group mGroup)
+				{
+					mInternal.forEachCandidate([&mBodies, mGroup](Body<TW>* mBody){ if(mBody->hasGroup(mGroup)) mBodies.emplace_back(mBody); });
+				}
+			};
+		}
+
+		template<typename TW> struct Point : public Base<TW>
+		{
+			template<typename... TArgs> Point(TArgs&&... mArgs) : Base<TW>(FWD(mArgs)...) { }
+
+			template<typename TF> inline void forEachCandidate(const TF& mFn) const
+			{
+				const Vec2i point(this->startPos);
+				this->forEachLeafBody([&point](const Impl::TreeBox& mBox){ return mBox.contains(point); }, mFn);
+			}
+			inline bool getSorting(const Body<TW>*, const Body<TW>*) const noexcept	{ return false; }
+			inline bool hits(const AABB& mShape) const noexcept						{ return mShape.contains(Vec2i(this->startPos)); }
+			inline void setOut(const AABB&) const noexcept							{ }
+		};
+
+		template<typename TW> struct Region : public Base<TW>
+		{
+			AABB region;
+
+			Region(const AABBTree<TW>& mTree, const AABB& mRegion) : Base<TW>{mTree, mRegion.getPosition()}, region{mRegion} { }
+
+			template<typename TF> inline void forEachCandidate(const TF& mFn) const
+			{
+				this->forEachLeafBody([this](const Impl::TreeBox& mBox){ return mBox.isOverlapping(region); }, mFn);
+			}
+			inline bool getSorting(const Body<TW>*, const Body<TW>*) const noexcept	{ return false; }
+			inline bool hits(const AABB& mShape) const noexcept						{ return mShape.isOverlapping(region); }
+			inline void setOut(const AABB& mShape) noexcept							{ this->lastPos = Vec2f(mShape.getPosition()); }
+		};
+
+		template<typename TW> struct RayCast : public Base<TW>
+		{
+			Vec2f dir, endPos;
+
+			RayCast(const AABBTree<TW>& mTree, const Vec2i& mPos, const Vec2f& mDir) : Base<TW>{mTree, mPos}, dir{mDir}, endPos{this->startPos}
+			{
+				// The tree is unbounded: the ray ends where it leaves the root's box
+				const auto* bounds(this->tree.getBounds());
+				float tMin{0.f}, tMax{ssvu::NumLimits<float>::max()};
+				if(bounds != nullptr && bounds->getRayRange(this->startPos, dir, tMin, tMax)) endPos = this->startPos + dir * tMax;
+			}
+
+			template<typename TF> inline void forEachCandidate(const TF& mFn) const
+			{
+				this->forEachLeafBody([this](const Impl::TreeBox& mBox){ float tMin{0.f}, tMax{1.f}; return mBox.getRayRange(this->startPos, endPos - this->startPos, tMin, tMax); }, mFn);
+			}
+			inline bool getSorting(const Body<TW>* mA, const Body<TW>* mB) const { return this->sortByDistance(mA, mB); }
+			inline bool hits(const AABB& mShape)
+			{
+				Segment<float> ray{this->startPos, endPos};
+				Vec2f intersection;
+
+				if(Utils::isSegmentInsersecting(ray, {dir.x > 0 ? mShape.getSegmentLeft<float>() : mShape.getSegmentRight<float>()}, intersection) ||
+				   Utils::isSegmentInsersecting(ray, {dir.y > 0 ? mShape.getSegmentTop<float>() : mShape.getSegmentBottom<float>()}, intersection))
+				{
+					this->lastPos = intersection;
+					return true;
+				}
+
+				return false;
+			}
+			inline void setOut(const AABB&) const noexcept { }
+		};
+
+		template<typename TW> struct Distance : public Base<TW>
+		{
+			int distance;
+
+			Distance(const AABBTree<TW>& mTree, const Vec2i& mPos, int mDistance) : Base<TW>{mTree, mPos}, distance{mDistance} { }
+
+			template<typename TF> inline void forEachCandidate(const TF& mFn) const
+			{
+				const float distSquared(distance * distance);
+				this->forEachLeafBody([this, distSquared](const Impl::TreeBox& mBox){ return mBox.getDistSquared(this->startPos) <= distSquared; }, mFn);
+			}
+			inline bool getSorting(const Body<TW>* mA, const Body<TW>* mB) const { return this->sortByDistance(mA, mB); }
+			inline bool hits(const AABB& mShape)
+			{
+				Vec2i test{this->startPos.x < mShape.getX() ? mShape.getLeft() : mShape.getRight(), this->startPos.y < mShape.getY() ? mShape.getTop() : mShape.getBottom()};
+
+				if(ssvs::getDistSquaredEuclidean(test, this->startPos) > pow(distance, 2)) return false;
+
+				this->lastPos = Vec2f(test);
+				return true;
+			}
+			inline void setOut(const AABB&) const noexcept { }
+		};
+	}
+}
+
+#endif
@@ -7,22 +7,37 @@
 
 namespace ssvsc
 {
+	namespace Impl
+	{
+		template<typename TW, typename TTag> class CellArena;
+		template<typename TW> class StaticLayer;
+	}
+
+	// A cell only stores the heads of its lists of body and sensor chunks in the grid's arenas, and the range of its row in the static layer,
+	// so empty cells own no memory
 	template<typename TW> class Cell
 	{
 		public:
-			using BaseType = Base<TW>;
-			using BodyType = Body<TW>;
+			template<typename, typename> friend class Impl::CellArena;
+			friend Impl::StaticLayer<TW>;
 
 		private:
-			std::vector<BodyType*> bodies;
+			Impl::CellList bodies, sensors;
+			std::uint32_t staticBegin{0}, staticCount{0};
+
+			inline auto& getList(BodyTag) noexcept					{ return bodies; }
+			inline auto& getList(SensorTag) noexcept				{ return sensors; }
+			inline const auto& getList(BodyTag) const noexcept		{ return bodies; }
+			inline const auto& getList(SensorTag) const noexcept	{ return sensors; }
 
 		public:
-			inline void add(BaseType* mBase, BodyTag) { SSVU_ASSERT(mBase != nullptr); bodies.emplace_back(ssvu::castUp<BodyType>(mBase)); }
-			inline void del(BaseType* mBase, BodyTag) { SSVU_ASSERT(mBase != nullptr); ssvu::eraseRemove(bodies, ssvu::castUp<BodyType>(mBase)); }
-			inline void add(BaseType*, SensorTag) { }
-			inline void del(BaseType*, SensorTag) { }
+			// Baked statics are not counted by `getBodyCount`, and tombstoned ones are counted by `getStaticCount` until the next bake
+			inline SizeT getBodyCount() const noexcept		{ return bodies.count; }
+			inline SizeT getSensorCount() const noexcept	{ return sensors.count; }
+			inline SizeT getStaticCount() const noexcept	{ return staticCount; }
 
-			inline const auto& getBodies() const noexcept { return bodies; }
+			// A cell is only empty (and can be reclaimed) when no body nor sensor is in it
+			inline bool isEmpty() const noexcept { return bodies.count == 0 && sensors.count == 0 && staticCount == 0; }
 	};
 }
 
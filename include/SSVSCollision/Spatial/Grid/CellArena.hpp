@@ -0,0 +1,192 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_GRID_CELLARENA
+#define SSVSC_SPATIAL_GRID_CELLARENA
+
+namespace ssvsc
+{
+	template<typename TW> class Cell;
+
+	namespace Impl
+	{
+		// Location of an entry inside the arena: chunk index and slot in the chunk
+		struct CellSlot { std::uint32_t chunk, slot; };
+
+		// Head chunk and size of the list of bodies (or sensors) of a cell
+		struct CellList { std::uint32_t head{ssvu::NumLimits<std::uint32_t>::max()}, count{0}; };
+
+		// Shared storage for the bodies (with `BodyTag`) or sensors (with `SensorTag`) of every cell of a grid
+		// Each cell owns a singly-linked list of fixed-size chunks: only the head chunk is partially filled, so insertion appends to it and
+		// removal moves the last entry of the head chunk into the hole, both in O(1)
+		// Every entry remembers which membership of its body it corresponds to, so the body can be told when its entry moves
+		// Chunks also keep a copy of the edges of their bodies, refreshed by `GridInfo` whenever a body's shape may have changed, and of their
+		// group masks, refreshed whenever they change, so that a whole chunk can be filtered at once (see `getOverlapMask` and `getGroupMask`)
+		template<typename TW, typename TTag> class CellArena
+		{
+			public:
+				using ItemType = std::conditional_t<std::is_same<TTag, BodyTag>::value, Body<TW>, Sensor<TW>>;
+				using CellType = Cell<TW>;
+				static constexpr std::uint32_t null{ssvu::NumLimits<std::uint32_t>::max()};
+				static constexpr std::uint32_t chunkSize{overlapBatchSize};
+
+			private:
+				struct Entry { ItemType* item; std::uint32_t membership; };
+				struct Chunk { OverlapBatch edges; GroupBatch groups; Entry entries[chunkSize]; std::uint32_t next; };
+
+				std::vector<Chunk> chunks;
+				std::vector<std::uint32_t> freeChunks;
+
+				inline static CellList& getList(CellType& mCell) noexcept				{ return mCell.getList(TTag{}); }
+				inline static const CellList& getList(const CellType& mCell) noexcept	{ return mCell.getList(TTag{}); }
+
+				inline std::uint32_t allocChunk(std::uint32_t mNext)
+				{
+					std::uint32_t idx;
+					if(freeChunks.empty()) { idx = chunks.size(); chunks.emplace_back(); }
+					else { idx = freeChunks.back(); freeChunks.pop_back(); }
+
+					chunks[idx].next = mNext;
+					return idx;
+				}
+
+				// Calls `mFn(chunk, count)` for every chunk of `mList`, where only the first `count` entries of `chunk` are used
+				template<typename TF> inline void forEachChunk(const CellList& mList, TF mFn) const
+				{
+					if(mList.count == 0) return;
+
+					auto n(((mList.count - 1) % chunkSize) + 1);
+					for(auto c(mList.head); c != null; c = chunks[c].next, n = chunkSize) mFn(chunks[c], n);
+				}
+
+			public:
+				inline CellSlot add(CellType& mCell, ItemType* mItem, std::uint32_t mMembership)
+				{
+					SSVU_ASSERT(mItem != nullptr);
+					auto& list(getList(mCell));
+
+					const auto slot(list.count % chunkSize);
+					if(slot == 0) list.head = allocChunk(list.head);
+
+					auto& chunk(chunks[list.head]);
+					chunk.entries[slot] = {mItem, mMembership};
+					chunk.edges.set(slot, mItem->getShape());
+					chunk.groups.set(slot, mItem->getGroups(), mItem->getGroupsToCheck());
+					++list.count;
+					return {list.head, slot};
+				}
+
+				inline void del(CellType& mCell, const CellSlot& mSlot)
+				{
+					auto& list(getList(mCell));
+					SSVU_ASSERT(list.count > 0);
+
+					const auto lastSlot((list.count - 1) % chunkSize);
+					auto& head(chunks[list.head]);
+					auto& last(head.entries[lastSlot]);
+
+					if(mSlot.chunk != list.head || mSlot.slot != lastSlot)
+					{
+						auto& chunk(chunks[mSlot.chunk]);
+						chunk.entries[mSlot.slot] = last;
+						chunk.edges.copy(mSlot.slot, head.edges, lastSlot);
+						chunk.groups.copy(mSlot.slot, head.groups, lastSlot);
+						last.item->getSpatialInfo().setCellSlot(last.membership, mSlot);
+					}
+
+					if(--list.count % chunkSize == 0)
+					{
+						const auto emptied(list.head);
+						list.head = chunks[emptied].next;
+						freeChunks.emplace_back(emptied);
+					}
+				}
+
+				template<typename TF> inline void forEach(const CellType& mCell, TF mFn) const
+				{
+					forEachChunk(getList(mCell), [&mFn](const Chunk& mChunk, std::uint32_t mCount){ for(auto i(0u); i < mCount; ++i) mFn(mChunk.entries[i].item); });
+				}
+
+				// Like `forEach`, but only for the entries belonging to any of `mGroups`, filtered by their stored group masks
+				template<typename TF> inline void forEachInGroups(const CellType& mCell, const GroupBitset& mGroups, TF mFn) const
+				{
+					const auto groups(toGroupBits(mGroups));
+					forEachChunk(getList(mCell), [groups, &mFn](const Chunk& mChunk, std::uint32_t mCount)
+					{
+						forEachBit(getGroupMask(mChunk.groups, groups, 0, mCount), [&mChunk, &mFn](std::uint32_t mIdx){ mFn(mChunk.entries[mIdx].item); });
+					});
+				}
+
+				inline void setEdges(const CellSlot& mSlot, const AABB& mShape) noexcept { chunks[mSlot.chunk].edges.set(mSlot.slot, mShape); }
+				inline void setGroups(const CellSlot& mSlot, const GroupBitset& mGroups, const GroupBitset& mGroupsToCheck) noexcept
+				{
+					chunks[mSlot.chunk].groups.set(mSlot.slot, mGroups, mGroupsToCheck);
+				}
+
+				// Like `forEach`, but only for the entries whose stored edges overlap `mShape`, and which belong to any of `mGroupsToCheck` or check any of `mGroups`
+				// Both filters run on whole chunks, before any body memory is touched
+				template<typename TF> inline void forEachOverlapping(const CellType& mCell, const AABB& mShape, const GroupBitset& mGroupsToCheck, const GroupBitset& mGroups, TF mFn) const
+				{
+					const auto groupsToCheck(toGroupBits(mGroupsToCheck)), groups(toGroupBits(mGroups));
+					forEachChunk(getList(mCell), [&mShape, groupsToCheck, groups, &mFn](const Chunk& mChunk, std::uint32_t mCount)
+					{
+						const auto mask(getGroupMask(mChunk.groups, groupsToCheck, groups, mCount));
+						if(mask != 0) forEachBit(mask & getOverlapMask(mShape, mChunk.edges, mCount), [&mChunk, &mFn](std::uint32_t mIdx){ mFn(mChunk.entries[mIdx].item); });
+					});
+				}
+
+				// Bulk counterpart of `add`, refilling the whole arena at once: `mForEachEntry(mFn)` must call `mFn(cell, item, membership)` for every entry,
+				// in the same order on both of its calls (counting, then filling), and the lists of the previous contents must have been emptied with `reset`
+				// Like `StaticLayer::bake`, entries are counted per cell, so that every cell gets its chunks back to back; the layout is the same as
+				// adding the entries one after the other, the last chunk of a cell being its (partially filled) head
+				template<typename TF> inline void rebuild(TF mForEachEntry)
+				{
+					clear();
+
+					std::vector<CellType*> filled;
+					mForEachEntry([&filled](CellType& mCell, ItemType*, std::uint32_t){ if(getList(mCell).count++ == 0) filled.emplace_back(&mCell); });
+
+					// Until the lists are linked, `head` is the first chunk of the cell and `count` the number of entries placed so far
+					std::uint32_t chunkCount{0};
+					for(const auto& c : filled)
+					{
+						auto& list(getList(*c));
+						const auto first(chunkCount);
+						chunkCount += (list.count + chunkSize - 1) / chunkSize;
+						list = {first, 0};
+					}
+					chunks.resize(chunkCount);
+
+					mForEachEntry([this](CellType& mCell, ItemType* mItem, std::uint32_t mMembership)
+					{
+						SSVU_ASSERT(mItem != nullptr);
+						auto& list(getList(mCell));
+						const CellSlot slot{list.head + list.count / chunkSize, list.count % chunkSize};
+						++list.count;
+
+						auto& chunk(chunks[slot.chunk]);
+						chunk.entries[slot.slot] = {mItem, mMembership};
+						chunk.edges.set(slot.slot, mItem->getShape());
+						chunk.groups.set(slot.slot, mItem->getGroups(), mItem->getGroupsToCheck());
+						mItem->getSpatialInfo().setCellSlot(mMembership, slot);
+					});
+
+					for(const auto& c : filled)
+					{
+						auto& list(getList(*c));
+						const auto last(list.head + (list.count - 1) / chunkSize);
+						for(auto i(list.head); i <= last; ++i) chunks[i].next = i == list.head ? null : i - 1;
+						list.head = last;
+					}
+				}
+				inline void reset(CellType& mCell) noexcept { getList(mCell) = {}; }
+
+				inline void clear() noexcept { chunks.clear(); freeChunks.clear(); }
+
+				inline SizeT getChunkCount() const noexcept { return chunks.size() - freeChunks.size(); }
+		};
+	}
+}
+
+#endif
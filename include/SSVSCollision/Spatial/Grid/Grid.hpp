@@ -5,8 +5,12 @@
 #ifndef SSVSC_SPATIAL_GRID
 #define SSVSC_SPATIAL_GRID
 
+#include "SSVSCollision/Spatial/Grid/CellArena.hpp"
+#include "SSVSCollision/Spatial/Grid/StaticLayer.hpp"
+#include "SSVSCollision/Spatial/Grid/StaticLevel.hpp"
 #include "SSVSCollision/Spatial/Grid/Cell.hpp"
 #include "SSVSCollision/Spatial/Grid/GridInfo.hpp"
+#include "SSVSCollision/Spatial/Grid/GridRegion.hpp"
 
 namespace ssvsc
 {
@@ -14,6 +18,173 @@ namespace ssvsc
 
 	namespace Impl
 	{
+		// Sparse cell storage: a flat hash map from 1D cell index to a slot in a paged pool of cells
+		// Cells never move, as grid infos keep pointers to them; reclaimed cells are recycled by later insertions
+		template<typename TW> class HashGridCells
+		{
+			public:
+				using CellType = Cell<TW>;
+
+			private:
+				FlatHashMap<int, SizeT> slots;
+				PagedVector<CellType> pool;
+				std::vector<SizeT> freeSlots;
+
+			public:
+				inline CellType& operator[](int mKey)
+				{
+					auto& slot(slots[mKey]);
+					if(slot != 0) return pool[slot - 1];
+
+					// Slots are stored offset by one, so that zero (the default value) marks a new entry
+					if(freeSlots.empty()) { pool.emplace_back(); slot = pool.size(); }
+					else { slot = freeSlots.back() + 1; freeSlots.pop_back(); }
+
+					return pool[slot - 1];
+				}
+				inline const CellType* find(int mKey) const noexcept
+				{
+					const auto slot(slots.find(mKey));
+					return slot == nullptr ? nullptr : &pool[*slot - 1];
+				}
+				inline const CellType& at(int mKey) const
+				{
+					const auto slot(slots.find(mKey));
+					if(slot == nullptr) throw std::out_of_range{"ssvsc::Impl::HashGridCells::at"};
+					return pool[*slot - 1];
+				}
+
+				// Releases every cell containing neither bodies nor sensors; their memory is kept for later reuse
+				inline void reclaimEmpty()
+				{
+					slots.eraseIf([this](int, SizeT mSlot)
+					{
+						if(!pool[mSlot - 1].isEmpty()) return false;
+
+						freeSlots.emplace_back(mSlot - 1);
+						return true;
+					});
+				}
+
+				inline SizeT size() const noexcept { return slots.size(); }
+				template<typename TF> inline void forEach(TF mFn) const { slots.forEach([this, &mFn](int mKey, SizeT mSlot){ mFn(mKey, pool[mSlot - 1]); }); }
+		};
+
+		// Packs two (possibly negative) coordinates in a single hash map key
+		inline std::uint64_t getGridKey(int mX, int mY) noexcept { return (std::uint64_t(std::uint32_t(mX)) << 32) | std::uint32_t(mY); }
+		inline Vec2i getGridKeyIdx(std::uint64_t mKey) noexcept { return {int(std::uint32_t(mKey >> 32)), int(std::uint32_t(mKey))}; }
+
+		// Unbounded cell storage: square pages of `pageCells` * `pageCells` cells, allocated the first time one of their cells is needed and
+		// found through a flat hash map from page coordinates; cell keys pack both cell coordinates (see `getGridKey`)
+		// Cells never move, as grid infos keep pointers to them; released pages are recycled by later allocations
+		template<typename TW> class ChunkedGridCells
+		{
+			public:
+				using CellType = Cell<TW>;
+
+			private:
+				struct Page { std::vector<CellType> cells; Vec2i idx; };
+
+				FlatHashMap<std::uint64_t, SizeT> slots;
+				PagedVector<Page> pool;
+				std::vector<SizeT> freeSlots;
+				int pageCells{16};
+				Vec2i pageMin{0, 0}, pageMax{-1, -1};
+
+				inline static int getFloorDiv(int mValue, int mDivisor) noexcept { return mValue / mDivisor - (mValue % mDivisor < 0 ? 1 : 0); }
+				inline SizeT getCellIdx(const Vec2i& mIdx, const Vec2i& mPage) const noexcept
+				{
+					return ssvu::get1DIdxFrom2D(mIdx.x - mPage.x * pageCells, mIdx.y - mPage.y * pageCells, pageCells);
+				}
+
+				inline void extendBounds(const Vec2i& mPage) noexcept
+				{
+					if(slots.size() == 1) { pageMin = pageMax = mPage; return; }
+
+					pageMin = {std::min(pageMin.x, mPage.x), std::min(pageMin.y, mPage.y)};
+					pageMax = {std::max(pageMax.x, mPage.x), std::max(pageMax.y, mPage.y)};
+				}
+
+			public:
+				inline void setPageCells(int mPageCells) noexcept { SSVU_ASSERT(mPageCells > 0 && slots.empty()); pageCells = mPageCells; }
+
+				inline Vec2i getPageIdx(const Vec2i& mIdx) const noexcept { return {getFloorDiv(mIdx.x, pageCells), getFloorDiv(mIdx.y, pageCells)}; }
+
+				inline CellType& operator[](std::uint64_t mKey)
+				{
+					const auto idx(getGridKeyIdx(mKey));
+					const auto page(getPageIdx(idx));
+
+					// Slots are stored offset by one, so that zero (the default value) marks a new page
+					auto& slot(slots[getGridKey(page.x, page.y)]);
+					if(slot == 0)
+					{
+						if(freeSlots.empty()) { pool.emplace_back(); pool.back().cells.resize(pageCells * pageCells); slot = pool.size(); }
+						else { slot = freeSlots.back() + 1; freeSlots.pop_back(); }
+
+						pool[slot - 1].idx = page;
+						extendBounds(page);
+					}
+
+					return pool[slot - 1].cells[getCellIdx(idx, page)];
+				}
+				inline const CellType* find(std::uint64_t mKey) const noexcept
+				{
+					const auto idx(getGridKeyIdx(mKey));
+					const auto page(getPageIdx(idx));
+					const auto slot(slots.find(getGridKey(page.x, page.y)));
+					return slot == nullptr ? nullptr : &pool[*slot - 1].cells[getCellIdx(idx, page)];
+				}
+				inline const CellType& at(std::uint64_t mKey) const
+				{
+					const auto cell(find(mKey));
+					if(cell == nullptr) throw std::out_of_range{"ssvsc::Impl::ChunkedGridCells::at"};
+					return *cell;
+				}
+
+				// Releases every page whose cells contain neither bodies nor sensors; their memory is kept for later reuse
+				inline void releaseEmpty()
+				{
+					slots.eraseIf([this](std::uint64_t, SizeT mSlot)
+					{
+						for(const auto& c : pool[mSlot - 1].cells) if(!c.isEmpty()) return false;
+
+						freeSlots.emplace_back(mSlot - 1);
+						return true;
+					});
+
+					pageMin = {0, 0};
+					pageMax = {-1, -1};
+					bool first{true};
+					slots.forEach([this, &first](std::uint64_t, SizeT mSlot)
+					{
+						const auto& page(pool[mSlot - 1].idx);
+						if(first) { pageMin = pageMax = page; first = false; return; }
+
+						pageMin = {std::min(pageMin.x, page.x), std::min(pageMin.y, page.y)};
+						pageMax = {std::max(pageMax.x, page.x), std::max(pageMax.y, page.y)};
+					});
+				}
+
+				inline bool hasPage(const Vec2i& mPage) const noexcept	{ return slots.find(getGridKey(mPage.x, mPage.y)) != nullptr; }
+				inline SizeT getPageCount() const noexcept				{ return slots.size(); }
+				inline int getPageCells() const noexcept				{ return pageCells; }
+
+				// Smallest and largest coordinates of the allocated pages; the maximum is smaller than the minimum when no page is allocated
+				inline const auto& getPageMin() const noexcept	{ return pageMin; }
+				inline const auto& getPageMax() const noexcept	{ return pageMax; }
+		};
+
+		template<typename TW> using HashGridType = HashGridCells<TW>;
+		template<typename TW> using GridType = std::vector<Cell<TW>>;
+
+		template<typename TW> inline const Cell<TW>* findCell(const GridType<TW>& mCells, int mKey) noexcept						{ return &mCells[mKey]; }
+		template<typename TW> inline const Cell<TW>* findCell(const HashGridType<TW>& mCells, int mKey) noexcept					{ return mCells.find(mKey); }
+		template<typename TW> inline const Cell<TW>* findCell(const ChunkedGridCells<TW>& mCells, std::uint64_t mKey) noexcept	{ return mCells.find(mKey); }
+
+		// Proxy body materialised for an entry of a `StaticLevel`, checked against the body store before use as the world may have destroyed it since
+		struct LevelProxy { BodyHandle handle{ssvu::NumLimits<SizeT>::max()}; std::uint32_t generation{0}; };
+
 		template<typename TW, typename TContainer, typename TDerived> class GridBase
 		{
 			public:
@@ -22,8 +193,15 @@ namespace ssvsc
 
 			protected:
 				TContainer cells;
+				CellArena<TW, BodyTag> arena;
+				CellArena<TW, SensorTag> sensorArena;
+				StaticLayer<TW> staticLayer;
+				const StaticLevel* staticLevel{nullptr};
+				FlatHashMap<std::uint32_t, LevelProxy> levelProxies;
 				int cols, rows, cellSize, offset;
 
+				inline const TDerived& getDerived() const noexcept { return static_cast<const TDerived&>(*this); }
+
 			public:
 				inline GridBase(int mCols, int mRows, int mCellSize, int mOffset = 0) : cols{mCols}, rows{mRows}, cellSize{mCellSize}, offset{mOffset} { }
 
@@ -39,29 +217,87 @@ namespace ssvsc
 				inline int getIdx(int mValue) const noexcept			{ SSVU_ASSERT(cellSize != 0); return mValue / cellSize; }
 				inline Vec2i getIdx(const Vec2i& mPos) const noexcept	{ return {getIdx(mPos.x), getIdx(mPos.y)}; }
 
-				inline const auto& getCell(int mX, int mY) const	{ return cells.at(ssvu::get1DIdxFrom2D(mX + offset, mY + offset, cols)); }
-				inline auto& getCell(int mX, int mY)				{ return cells[ssvu::get1DIdxFrom2D(mX + offset, mY + offset, cols)]; }
+				// Key of a cell in the container; derived grids addressing their cells differently provide their own
+				inline int getCellKey(int mX, int mY) const noexcept { return ssvu::get1DIdxFrom2D(mX + offset, mY + offset, cols); }
+
+				inline const auto& getCell(int mX, int mY) const	{ return cells.at(getDerived().getCellKey(mX, mY)); }
+				inline auto& getCell(int mX, int mY)				{ return cells[getDerived().getCellKey(mX, mY)]; }
 				inline const auto& getCell(const Vec2i& mIdx) const	{ return getCell(mIdx.x, mIdx.y); }
 				inline auto& getCell(const Vec2i& mIdx)				{ return getCell(mIdx.x, mIdx.y); }
 
 				inline const decltype(cells)& getCells() const noexcept { return cells; }
 				inline decltype(cells)& getCells() noexcept				{ return cells; }
+				inline const auto& getArena(BodyTag = {}) const noexcept	{ return arena; }
+				inline auto& getArena(BodyTag = {}) noexcept				{ return arena; }
+				inline const auto& getArena(SensorTag) const noexcept		{ return sensorArena; }
+				inline auto& getArena(SensorTag) noexcept					{ return sensorArena; }
+				inline const auto& getStaticLayer() const noexcept			{ return staticLayer; }
+				inline auto& getStaticLayer() noexcept						{ return staticLayer; }
+
+				// Moves the statics registered since the last call from the arena to the static layer; called by the world at the start of every update
+				inline void bakeStatics() { staticLayer.bake(arena); }
+
+				// Replaces the contents of the arena and of the static layer with `mBodies`, which must be every body in the grid: they are binned
+				// with a single counting sort (see `CellArena::rebuild`), laid out as if initialized one after the other, and statics are baked right away
+				// Called by `World::restore`, once all bodies have their restored shape
+				inline void rebuild(const std::vector<Body<TW>*>& mBodies)
+				{
+					for(const auto& b : mBodies) for(const auto& m : b->getSpatialInfo().memberships) arena.reset(*m.cell);
+					staticLayer.clear();
+					for(const auto& b : mBodies) b->getSpatialInfo().calcCellsBulk();
+
+					arena.rebuild([&mBodies](auto&& mFn)
+					{
+						for(const auto& b : mBodies)
+						{
+							const auto& info(b->getSpatialInfo());
+							if(!info.baked) for(auto i(0u); i < info.memberships.size(); ++i) mFn(*info.memberships[i].cell, b, i);
+						}
+					});
+					staticLayer.bake(arena);
+				}
+
+				// See `World::setStaticLevel`
+				inline void setStaticLevel(const StaticLevel* mLevel)
+				{
+					if(mLevel != nullptr && (mLevel->getColumns() != cols || mLevel->getRows() != rows || mLevel->getCellSize() != cellSize || mLevel->getOffset() != offset))
+						throw std::runtime_error{"ssvsc::Impl::GridBase::setStaticLevel: level baked for another grid layout"};
+
+					staticLevel = mLevel;
+					levelProxies.clear();
+				}
+				inline const StaticLevel* getStaticLevel() const noexcept	{ return staticLevel; }
+				inline auto& getLevelProxies() noexcept						{ return levelProxies; }
+
+				template<typename TF> inline void forEachBody(const CellType& mCell, TF mFn) const { arena.forEach(mCell, mFn); staticLayer.forEach(mCell, mFn); }
+
+				// Read-only visit of the bodies in a valid cell, which (unlike `getCell`) never creates nor requires the cell: safe to call from several threads
+				template<typename TF> inline void forEachBodyAt(const Vec2i& mIdx, TF mFn) const
+				{
+					const auto* cell(findCell(cells, getDerived().getCellKey(mIdx.x, mIdx.y)));
+					if(cell != nullptr) forEachBody(*cell, mFn);
+				}
+				template<typename TF> inline void forEachBodyInGroupsAt(const Vec2i& mIdx, const GroupBitset& mGroups, TF mFn) const
+				{
+					const auto* cell(findCell(cells, getDerived().getCellKey(mIdx.x, mIdx.y)));
+					if(cell == nullptr) return;
+
+					arena.forEachInGroups(*cell, mGroups, mFn);
+					staticLayer.forEachInGroups(*cell, mGroups, mFn);
+				}
+				template<typename TFilter, typename TF> inline void forEachOverlapping(const AABB& mRegion, const TFilter& mFilter, const TF& mFn) const
+				{
+					forEachInGridRegion(getDerived(), mRegion, mFilter, mFn);
+				}
+				template<typename TBound, typename TFilter, typename TF> inline void forEachNear(const Vec2f& mPos, const TBound& mGetBoundSquared, const TFilter& mFilter, const TF& mFn) const
+				{
+					forEachInGridRings(getDerived(), mPos, mGetBoundSquared, mFilter, mFn);
+				}
 
 				inline bool isIdxValid(const Vec2i& mIdx) const noexcept					{ return mIdx.x >= getIdxXMin() && mIdx.x < getIdxXMax() && mIdx.y >= getIdxYMin() && mIdx.y < getIdxYMax(); }
 				inline bool isIdxValid(int mX1, int mY1, int mX2, int mY2) const noexcept	{ return mX1 >= getIdxXMin() && mX2 < getIdxXMax() && mY1 >= getIdxYMin() && mY2 < getIdxYMax(); }
 		};
 
-		struct HashGridHash
-		{
-			inline SizeT operator()(int mKey) const noexcept { return mKey; }
-		};
-		struct HashGridEqual
-		{
-			inline bool operator()(int mA, int mB) const noexcept { return mA == mB; }
-		};
-
-		template<typename TW> using HashGridType = std::unordered_map<int, Cell<TW>, HashGridHash, HashGridEqual>;
-		template<typename TW> using GridType = std::vector<Cell<TW>>;
 	}
 
 	template<typename TW> struct Grid final : public Impl::GridBase<TW, Impl::GridType<TW>, Grid<TW>>
@@ -69,7 +305,7 @@ namespace ssvsc
 		inline Grid(int mCols, int mRows, int mCellSize, int mOffset = 0)
 			: Impl::GridBase<TW, Impl::GridType<TW>, Grid<TW>>{mCols, mRows, mCellSize, mOffset}
 		{
-			this->cells.reserve(this->cols * this->rows);
+			this->cells.resize(this->cols * this->rows);
 		}
 	};
 
@@ -80,8 +316,52 @@ namespace ssvsc
 		{
 
 		}
+
+		// Empty cells are kept around by default, as bodies moving back and forth would otherwise keep recreating them
+		// Call this periodically (e.g. once every few seconds) to release the cells of areas nothing occupies anymore
+		inline void reclaimEmptyCells() { this->cells.reclaimEmpty(); }
+	};
+
+	// Grid without fixed extents, for unbounded maps: cells are allocated by square pages of `pageCells` * `pageCells` cells, the first time a
+	// body (or sensor) enters one of them, so memory follows the occupied area instead of the size of the map, and nothing is ever out of bounds
+	// Queries only cover the allocated pages; pages nothing occupies anymore are kept until `releaseEmptyPages`
+	// Static levels, baked for fixed extents, cannot be attached; see `ChunkStreamer` to keep bodies (and pages) loaded only around points of interest
+	template<typename TW> struct ChunkedGrid final : public Impl::GridBase<TW, Impl::ChunkedGridCells<TW>, ChunkedGrid<TW>>
+	{
+		inline ChunkedGrid(int mCellSize, int mPageCells = 16) : Impl::GridBase<TW, Impl::ChunkedGridCells<TW>, ChunkedGrid<TW>>{0, 0, mCellSize}
+		{
+			this->cells.setPageCells(mPageCells);
+		}
+
+		inline std::uint64_t getCellKey(int mX, int mY) const noexcept { return Impl::getGridKey(mX, mY); }
+
+		inline int getIdxXMin() const noexcept	{ return this->cells.getPageMin().x * getPageCells(); }
+		inline int getIdxYMin() const noexcept	{ return this->cells.getPageMin().y * getPageCells(); }
+		inline int getIdxXMax() const noexcept	{ return (this->cells.getPageMax().x + 1) * getPageCells(); }
+		inline int getIdxYMax() const noexcept	{ return (this->cells.getPageMax().y + 1) * getPageCells(); }
+
+		// Only cells of allocated pages are valid for queries, while bodies can span any cell
+		inline bool isIdxValid(const Vec2i& mIdx) const noexcept	{ return mIdx.x >= getIdxXMin() && mIdx.x < getIdxXMax() && mIdx.y >= getIdxYMin() && mIdx.y < getIdxYMax(); }
+		inline bool isIdxValid(int, int, int, int) const noexcept	{ return true; }
+
+		inline int getPageCells() const noexcept					{ return this->cells.getPageCells(); }
+		inline int getPageSize() const noexcept						{ return getPageCells() * this->cellSize; }
+		inline Vec2i getPageIdx(const Vec2i& mIdx) const noexcept	{ return this->cells.getPageIdx(mIdx); }
+		inline bool hasPage(const Vec2i& mPage) const noexcept		{ return this->cells.hasPage(mPage); }
+		inline SizeT getPageCount() const noexcept					{ return this->cells.getPageCount(); }
+
+		// Releases the pages nothing occupies anymore (their memory is recycled by later allocations); must not be called while the world is updating
+		// Statics are baked first, as removed statics keep their cells occupied until the next bake
+		inline void releaseEmptyPages() { this->bakeStatics(); this->cells.releaseEmpty(); }
 	};
 
+	namespace Impl
+	{
+		template<typename TW> struct SpatialTraits<Grid<TW>> { static constexpr bool rebuildsEachFrame{false}, bakesStatics{true}, rebuildsInBulk{true}, hasStaticLevels{true}, joinsInBulk{false}; };
+		template<typename TW> struct SpatialTraits<HashGrid<TW>> { static constexpr bool rebuildsEachFrame{false}, bakesStatics{true}, rebuildsInBulk{true}, hasStaticLevels{true}, joinsInBulk{false}; };
+		template<typename TW> struct SpatialTraits<ChunkedGrid<TW>> { static constexpr bool rebuildsEachFrame{false}, bakesStatics{true}, rebuildsInBulk{true}, hasStaticLevels{false}, joinsInBulk{false}; };
+	}
+
 	namespace GridQueryTypes
 	{
 		template<typename TW, typename TGrid> struct Point;
@@ -91,6 +371,7 @@ namespace ssvsc
 		template<typename TW, typename TGrid> struct OrthoRight;
 		template<typename TW, typename TGrid> struct OrthoUp;
 		template<typename TW, typename TGrid> struct OrthoDown;
+		template<typename TW, typename TGrid> struct Region;
 		namespace Bodies { template<typename TW> struct All; template<typename TW> struct ByGroup; }
 	}
 
@@ -101,6 +382,7 @@ namespace ssvsc
 	template<typename TW, typename TGrid> struct QueryTypeDispatcher<TW, TGrid, QueryType::OrthoRight>	{ using Type = GridQueryTypes::OrthoRight<TW, TGrid>; };
 	template<typename TW, typename TGrid> struct QueryTypeDispatcher<TW, TGrid, QueryType::OrthoUp>		{ using Type = GridQueryTypes::OrthoUp<TW, TGrid>; };
 	template<typename TW, typename TGrid> struct QueryTypeDispatcher<TW, TGrid, QueryType::OrthoDown>	{ using Type = GridQueryTypes::OrthoDown<TW, TGrid>; };
+	template<typename TW, typename TGrid> struct QueryTypeDispatcher<TW, TGrid, QueryType::Region>		{ using Type = GridQueryTypes::Region<TW, TGrid>; };
 
 	template<typename TW, typename TGrid> struct QueryModeDispatcher<TW, TGrid, QueryMode::All>			{ using Type = GridQueryTypes::Bodies::All<TW>; };
 	template<typename TW, typename TGrid> struct QueryModeDispatcher<TW, TGrid, QueryMode::ByGroup>		{ using Type = GridQueryTypes::Bodies::ByGroup<TW>; };
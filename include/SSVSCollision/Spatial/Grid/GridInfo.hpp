@@ -7,6 +7,11 @@
 
 namespace ssvsc
 {
+	namespace Impl
+	{
+		template<typename TW, typename TContainer, typename TDerived> class GridBase;
+	}
+
 	template<typename TW> class GridInfo
 	{
 		public:
@@ -15,25 +20,33 @@ namespace ssvsc
 			using BodyType = Body<TW>;
 			using SensorType = Sensor<TW>;
 			using CellType = Cell<TW>;
+			friend Impl::CellArena<TW, BodyTag>;
+			friend Impl::CellArena<TW, SensorTag>;
+			friend Impl::StaticLayer<TW>;
+			template<typename, typename, typename> friend class Impl::GridBase;
 
 		private:
+			// A cell spanned by the body (or sensor), and where it is stored in the grid's arena (or static layer, once baked)
+			struct Membership { CellType* cell; Impl::CellSlot slot; };
+
 			SpatialType& grid;
 
 			// TODO: unnecessary if inheritance is used
 			BaseType& base;
 
-			std::vector<CellType*> cells;
+			std::vector<Membership> memberships;
 			int startX{0}, startY{0}, endX{0}, endY{0}, oldStartX{-1}, oldStartY{-1}, oldEndX{-1}, oldEndY{-1}, spatialPaint{-1};
-			bool invalid{true};
+			SizeT scanFrame{0}, staticIdx{Impl::StaticLayer<TW>::null};
+			bool invalid{true}, moved{true}, baked{false};
 
-			inline const AABB& getShapeImpl(BodyTag) const noexcept		{ return ssvu::castUp<BodyType>(base).getShape(); }
-			inline const AABB& getShapeImpl(SensorTag) const noexcept	{ return ssvu::castUp<SensorType>(base).getShape(); }
-			inline void handleCollisionImpl(FT mFT, BodyType* mBody, BodyTag) const noexcept	{ SSVU_ASSERT(mBody != nullptr); ssvu::castUp<BodyType>(base).handleCollision(mFT, mBody); }
-			inline void handleCollisionImpl(FT mFT, BodyType* mBody, SensorTag) const noexcept	{ SSVU_ASSERT(mBody != nullptr); ssvu::castUp<SensorType>(base).handleCollision(mFT, mBody); }
+			inline BodyType& getItem(BodyTag) const noexcept		{ return ssvu::castUp<BodyType>(base); }
+			inline SensorType& getItem(SensorTag) const noexcept	{ return ssvu::castUp<SensorType>(base); }
+			template<typename TTag> inline const AABB& getShapeImpl() const noexcept { return getItem(TTag{}).getShape(); }
 
 			template<typename TTag> inline void calcEdges()
 			{
-				const auto& shape(getShapeImpl(TTag{}));
+				const auto& shape(getShapeImpl<TTag>());
+				moved = true;
 
 				oldStartX = startX;
 				oldStartY = startY;
@@ -45,52 +58,178 @@ namespace ssvsc
 				endX = grid.getIdx(shape.getRight());
 				endY = grid.getIdx(shape.getBottom());
 
-				if(oldStartX != startX || oldStartY != startY || oldEndX != endX || oldEndY != endY) calcCells<TTag>();
-				else invalid = false;
+				if(oldStartX != startX || oldStartY != startY || oldEndX != endX || oldEndY != endY || mustChangeLayer(TTag{})) calcCells<TTag>();
+				else { setEdges<TTag>(); invalid = false; }
 			}
 			template<typename TTag> inline void calcCells()
 			{
 				clear<TTag>();
+				SSVSC_STATS_COUNT(base.getWorld(), rebins, 1);
 
 				if(!grid.isIdxValid(startX, startY, endX, endY)) { base.setOutOfBounds(true); return; }
+				registerStatic(TTag{});
 				for(int iX{startX}; iX <= endX; ++iX)
 					for(int iY{startY}; iY <= endY; ++iY)
 					{
 						auto& c(grid.getCell(iX, iY));
-						cells.emplace_back(&c);
-						c.add(&base, TTag{});
+						memberships.push_back({&c, grid.getArena(TTag{}).add(c, &getItem(TTag{}), memberships.size())});
 					}
 
 				invalid = false;
 			}
 			template<typename TTag> inline void clear()
 			{
-				for(const auto& c : cells) c->del(&base, TTag{});
-				cells.clear();
+				if(baked) for(const auto& m : memberships) grid.getStaticLayer().tombstone(m.slot);
+				else for(const auto& m : memberships) grid.getArena(TTag{}).del(*m.cell, m.slot);
+
+				memberships.clear();
+				baked = false;
+				if(staticIdx != Impl::StaticLayer<TW>::null) { grid.getStaticLayer().del(staticIdx); staticIdx = Impl::StaticLayer<TW>::null; }
 			}
 
+			// Bulk counterpart of `init`, used by `GridBase::rebuild`: finds the cells spanned by the body without storing it in them, the arena
+			// being filled afterwards in one go; statics are marked as baked right away, as the rebuild bakes them without staging them in the arena
+			inline void calcCellsBulk()
+			{
+				const auto& shape(getShapeImpl<BodyTag>());
+				moved = true;
+
+				oldStartX = startX;
+				oldStartY = startY;
+				oldEndX = endX;
+				oldEndY = endY;
+
+				startX = grid.getIdx(shape.getLeft());
+				startY = grid.getIdx(shape.getTop());
+				endX = grid.getIdx(shape.getRight());
+				endY = grid.getIdx(shape.getBottom());
+
+				memberships.clear();
+				staticIdx = Impl::StaticLayer<TW>::null;
+				SSVSC_STATS_COUNT(base.getWorld(), rebins, 1);
+
+				if(!grid.isIdxValid(startX, startY, endX, endY)) { baked = false; base.setOutOfBounds(true); return; }
+				registerStatic(BodyTag{});
+				baked = staticIdx != Impl::StaticLayer<TW>::null;
+				for(int iX{startX}; iX <= endX; ++iX)
+					for(int iY{startY}; iY <= endY; ++iY)
+						memberships.push_back({&grid.getCell(iX, iY), {}});
+
+				invalid = false;
+			}
+
+			// Static bodies are registered in the static layer (while staying in the arena until it is baked again), and must rebin when they stop or start being static
+			inline bool mustChangeLayer(BodyTag) const noexcept	{ return (staticIdx != Impl::StaticLayer<TW>::null) != getItem(BodyTag{}).isStatic(); }
+			inline bool mustChangeLayer(SensorTag) const noexcept	{ return false; }
+			inline void registerStatic(BodyTag)		{ if(getItem(BodyTag{}).isStatic()) staticIdx = grid.getStaticLayer().add(&getItem(BodyTag{})); }
+			inline void registerStatic(SensorTag)	{ }
+
+			inline void setCellSlot(std::uint32_t mMembership, const Impl::CellSlot& mSlot) noexcept { memberships[mMembership].slot = mSlot; }
+
+			template<typename TTag> inline void setEdges() noexcept
+			{
+				if(baked) for(const auto& m : memberships) grid.getStaticLayer().setEdges(m.slot, getShapeImpl<TTag>());
+				else for(const auto& m : memberships) grid.getArena(TTag{}).setEdges(m.slot, getShapeImpl<TTag>());
+			}
+
+			// Sensors and baked statics only move through setters invalidating them: their stored edges are refreshed by `calcEdges`
+			inline void refreshEdges(BodyTag) noexcept		{ if(!baked) setEdges<BodyTag>(); }
+			inline void refreshEdges(SensorTag) noexcept	{ }
+
 			inline auto& getLastPaint() const noexcept { static int lastPaint{0}; return lastPaint; }
 
+			// Calls `mFn(item)` once for every other entry of the `TTag` arena (and for bodies, of the static layer) in the spanned cells passing the group masks and overlapping the stored edges
+			// (see `CellArena::forEachOverlapping`); every call to `detect` starts a new paint, so that entries spanning several cells are only visited once
+			template<typename TTag, typename TF> inline void forEachCandidate(const AABB& mShape, const GroupBitset& mGroupsToCheck, const GroupBitset& mGroups, TF mFn)
+			{
+				auto visit([this, &mFn](auto* mItem)
+				{
+					auto& info(mItem->getSpatialInfo());
+					if(&info == this || info.spatialPaint == getLastPaint()) return;
+
+					info.spatialPaint = getLastPaint();
+					mFn(*mItem);
+				});
+
+				for(const auto& m : memberships) forEachInCell(*m.cell, mShape, mGroupsToCheck, mGroups, visit, TTag{});
+				forEachInLevel(mShape, mGroupsToCheck, mGroups, visit, TTag{});
+			}
+			template<typename TF> inline void forEachInCell(const CellType& mCell, const AABB& mShape, const GroupBitset& mGroupsToCheck, const GroupBitset& mGroups, TF& mFn, BodyTag) const
+			{
+				grid.getArena(BodyTag{}).forEachOverlapping(mCell, mShape, mGroupsToCheck, mGroups, mFn);
+				grid.getStaticLayer().forEachOverlapping(mCell, mShape, mGroupsToCheck, mGroups, mFn);
+			}
+			template<typename TF> inline void forEachInCell(const CellType& mCell, const AABB& mShape, const GroupBitset& mGroupsToCheck, const GroupBitset& mGroups, TF& mFn, SensorTag) const
+			{
+				grid.getArena(SensorTag{}).forEachOverlapping(mCell, mShape, mGroupsToCheck, mGroups, mFn);
+			}
+
+			// Entries of the grid's static level are visited through their proxy body, created the first time one of them passes the filters
+			template<typename TF> inline void forEachInLevel(const AABB& mShape, const GroupBitset& mGroupsToCheck, const GroupBitset& mGroups, TF& mFn, BodyTag)
+			{
+				const auto* level(grid.getStaticLevel());
+				if(level == nullptr || memberships.empty()) return;
+
+				for(int iX{startX}; iX <= endX; ++iX)
+					for(int iY{startY}; iY <= endY; ++iY)
+						level->forEachOverlapping(iX, iY, mShape, mGroupsToCheck, mGroups, [this, &mFn](std::uint32_t mId){ mFn(&base.getWorld().getLevelProxy(mId)); });
+			}
+			template<typename TF> inline void forEachInLevel(const AABB&, const GroupBitset&, const GroupBitset&, TF&, SensorTag) const noexcept { }
+
+			// Moving bodies look for both the bodies and the sensors they overlap, so that idle sensors never need to look for them
+			inline void detect(FT mFT, BodyTag)
+			{
+				++(getLastPaint());
+				SSVSC_STATS_COUNT(base.getWorld(), cellsVisited, memberships.size());
+
+				auto& body(getItem(BodyTag{}));
+				const auto& shape(body.getShape());
+
+				forEachCandidate<BodyTag>(shape, base.getGroupsToCheck(), {}, [&body, mFT](BodyType& mBody){ body.handleCollision(mFT, &mBody); });
+				forEachCandidate<SensorTag>(shape, {}, base.getGroups(), [&body, mFT](SensorType& mSensor){ mSensor.handleCollision(mFT, &body); });
+			}
+
+			// Sensors only look for what they overlap on frames they moved (or were created): bodies stepped this frame already found them, and
+			// sensors which scanned this frame already handled their pair with this one
+			inline void detect(FT mFT, SensorTag)
+			{
+				if(!moved) return;
+				moved = false;
+				scanFrame = base.getWorld().getFrame();
+
+				++(getLastPaint());
+				SSVSC_STATS_COUNT(base.getWorld(), cellsVisited, memberships.size());
+
+				auto& sensor(getItem(SensorTag{}));
+				const auto& shape(sensor.getShape());
+				const auto frame(scanFrame);
+
+				forEachCandidate<BodyTag>(shape, base.getGroupsToCheck(), {}, [&sensor, mFT, frame](BodyType& mBody){ if(mBody.stepFrame != frame) sensor.handleCollision(mFT, &mBody); });
+				forEachCandidate<SensorTag>(shape, base.getGroupsToCheck(), base.getGroups(), [&sensor, mFT, frame](SensorType& mSensor)
+				{
+					if(mSensor.getSpatialInfo().scanFrame != frame) sensor.handleCollision(mFT, mSensor);
+				});
+			}
+
 		public:
 			inline GridInfo(SpatialType& mGrid, BaseType& mBase) noexcept : grid(mGrid), base(mBase) { }
 
 			template<typename TTag> inline void init()		{ calcEdges<TTag>(); calcCells<TTag>(); }
 			inline void invalidate() noexcept				{ invalid = true; }
-			template<typename TTag> inline void preUpdate()	{ if(invalid) calcEdges<TTag>(); }
-			inline void postUpdate() const noexcept			{ }
-			template<typename TTag> inline void destroy()	{ clear<TTag>(); }
-			template<typename TTag> inline void handleCollisions(FT mFT)
-			{
-				++(getLastPaint());
+			template<typename TTag> inline void preUpdate()	{ if(invalid) calcEdges<TTag>(); else refreshEdges(TTag{}); }
 
-				for(const auto& c : cells)
-					for(const auto& b : c->getBodies())
-					{
-						if(b->getSpatialInfo().spatialPaint == getLastPaint()) continue;
-						handleCollisionImpl(mFT, b, TTag{});
-						b->getSpatialInfo().spatialPaint = getLastPaint();
-					}
+			// Bodies call this after their shape changed outside of detection (integration, resolution), so that their cells store up-to-date edges
+			template<typename TTag> inline void postUpdate() noexcept	{ refreshEdges(TTag{}); }
+
+			// Called whenever the groups (or groups to check) change, so that the cells store up-to-date group masks
+			template<typename TTag> inline void refreshGroups() noexcept
+			{
+				if(baked) for(const auto& m : memberships) grid.getStaticLayer().setGroups(m.slot, base.getGroups(), base.getGroupsToCheck());
+				else for(const auto& m : memberships) grid.getArena(TTag{}).setGroups(m.slot, base.getGroups(), base.getGroupsToCheck());
 			}
+
+			template<typename TTag> inline void destroy()	{ clear<TTag>(); }
+			template<typename TTag> inline void handleCollisions(FT mFT) { detect(mFT, TTag{}); }
 	};
 }
 
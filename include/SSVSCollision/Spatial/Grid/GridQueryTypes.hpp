@@ -7,6 +7,37 @@
 
 namespace ssvsc
 {
+	namespace Impl
+	{
+		// Cell offsets of the square rings around a cell, from radius 0 to `maxRadius`, generated on the fly
+		// Ring `r` yields `(r, y)` and `(-r, y)` for every `y` in `[-r, r]`, then `(x, r)` and `(x, -r)` for every `x` in `(-r, r)`
+		class RingOffsets
+		{
+			private:
+				int radius{0}, maxRadius, step{0};
+
+				inline int getRingSize() const noexcept { return radius == 0 ? 1 : radius * 8; }
+
+			public:
+				inline RingOffsets(int mMaxRadius) noexcept : maxRadius{mMaxRadius} { }
+
+				inline bool empty() const noexcept { return radius > maxRadius; }
+				inline Vec2i front() const noexcept
+				{
+					SSVU_ASSERT(!empty());
+
+					const int side{(step % 2 == 0) ? radius : -radius}, columns{2 * (2 * radius + 1)};
+					if(step < columns) return {side, -radius + step / 2};
+					return {-radius + 1 + (step - columns) / 2, side};
+				}
+				inline void pop() noexcept
+				{
+					if(empty()) return;
+					if(++step == getRingSize()) { ++radius; step = 0; }
+				}
+		};
+	}
+
 	namespace GridQueryTypes
 	{
 		template<typename TW, typename TGrid> struct Base
@@ -25,15 +56,18 @@ namespace ssvsc
 		{
 			template<typename TW> struct All
 			{
-				template<typename T> inline static void getBodies(std::vector<Body<TW>*>& mBodies, const T& mInternal) { mBodies = mInternal.grid.getCell(mInternal.index).getBodies(); }
+				template<typename T> inline static void getBodies(std::vector<Body<TW>*>& mBodies, const T& mInternal)
+				{
+					mBodies.clear();
+					mInternal.grid.forEachBodyAt(mInternal.index, [&mBodies](Body<TW>* mBody){ mBodies.emplace_back(mBody); });
+				}
 			};
 			template<typename TW> struct ByGroup
 			{
 				template<typename T> inline static void getBodies(std::vector<Body<TW>*>& mBodies, const T& mInternal, Group mGroup)
 				{
-					std::vector<Body<TW>*> result;
-					for(const auto& b : mInternal.grid.getCell(mInternal.index).getBodies()) if(b->hasGroup(mGroup)) result.emplace_back(b);
-					mBodies = result;
+					mBodies.clear();
+					mInternal.grid.forEachBodyInGroupsAt(mInternal.index, GroupBitset{}.set(mGroup), [&mBodies](Body<TW>* mBody){ mBodies.emplace_back(mBody); });
 				}
 			};
 		}
@@ -75,6 +109,29 @@ namespace ssvsc
 			inline void setOut(const AABB& mShape)					{ this->lastPos = Vec2f(this->pos.x, mShape.getTop()); }
 		};
 
+		// Yields every body overlapping a rectangle, visiting the covered cells in row order
+		template<typename TW, typename TGrid> struct Region : public Base<TW, TGrid>
+		{
+			AABB region;
+			Impl::GridRegion range;
+			Vec2i current;
+
+			Region(TGrid& mGrid, const AABB& mRegion) : Base<TW, TGrid>{mGrid, mRegion.getPosition()}, region{mRegion}, range{mGrid, mRegion}
+			{
+				this->index = this->startIndex = {range.startX, range.startY};
+			}
+
+			inline bool isValid() const noexcept { return !range.isEmpty() && this->index.y <= range.endY; }
+			inline void step() noexcept
+			{
+				current = this->index;
+				if(++this->index.x > range.endX) { this->index.x = range.startX; ++this->index.y; }
+			}
+			inline bool getSorting(const Body<TW>*, const Body<TW>*) const noexcept { return false; }
+			inline bool hits(const AABB& mShape) const noexcept { return range.isReferenceCell(this->grid, mShape, current.x, current.y) && mShape.isOverlapping(region); }
+			inline void setOut(const AABB& mShape) noexcept { this->lastPos = Vec2f(mShape.getPosition()); }
+		};
+
 		template<typename TW, typename TGrid> struct Point : public Base<TW, TGrid>
 		{
 			bool finished{false};
@@ -162,25 +219,11 @@ namespace ssvsc
 		template<typename TW, typename TGrid> struct Distance : public Base<TW, TGrid>
 		{
 			int cellSize, distance, cellRadius;
-			std::queue<Vec2i> offsets;
+			Impl::RingOffsets offsets;
 
-			Distance(TGrid& mGrid, const Vec2i& mPos, int mDistance) : Base<TW, TGrid>{mGrid, mPos}, cellSize{this->grid.getCellSize()}, distance{mDistance}, cellRadius{distance / cellSize}
+			Distance(TGrid& mGrid, const Vec2i& mPos, int mDistance) : Base<TW, TGrid>{mGrid, mPos}, cellSize{this->grid.getCellSize()}, distance{mDistance}, cellRadius{distance / cellSize}, offsets{cellRadius}
 			{
 				SSVU_ASSERT(cellSize != 0);
-
-				for(int iRadius{0}; iRadius < cellRadius + 1; ++iRadius)
-				{
-					for(int iY{-iRadius}; iY <= iRadius; ++iY)
-					{
-						offsets.emplace(iRadius, iY);
-						if(-iRadius != iRadius) offsets.emplace(-iRadius, iY);
-					}
-					for(int iX{-iRadius + 1}; iX <= iRadius -1; ++iX)
-					{
-						offsets.emplace(iX, iRadius);
-						offsets.emplace(iX, -iRadius);
-					}
-				}
 			}
 
 			inline bool isValid() { return !offsets.empty() && this->grid.isIdxValid(this->index); }
@@ -188,7 +231,7 @@ namespace ssvsc
 			{
 				this->lastPos = this->pos;
 				this->index = this->startIndex + offsets.front();
-				if(!offsets.empty()) offsets.pop();
+				offsets.pop();
 			}
 			inline bool getSorting(const Body<TW>* mA, const Body<TW>* mB)
 			{
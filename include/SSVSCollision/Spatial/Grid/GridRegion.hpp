@@ -0,0 +1,88 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_GRIDREGION
+#define SSVSC_SPATIAL_GRIDREGION
+
+namespace ssvsc
+{
+	namespace Impl
+	{
+		// Range of grid cells covered by a region, clamped to the grid
+		struct GridRegion
+		{
+			int startX, startY, endX, endY;
+
+			template<typename TGrid> inline GridRegion(const TGrid& mGrid, const AABB& mRegion) noexcept
+				: startX{std::max(mGrid.getIdx(mRegion.getLeft()), mGrid.getIdxXMin())}, startY{std::max(mGrid.getIdx(mRegion.getTop()), mGrid.getIdxYMin())},
+				  endX{std::min(mGrid.getIdx(mRegion.getRight()), mGrid.getIdxXMax() - 1)}, endY{std::min(mGrid.getIdx(mRegion.getBottom()), mGrid.getIdxYMax() - 1)} { }
+
+			inline bool isEmpty() const noexcept { return startX > endX || startY > endY; }
+
+			// A body spanning several covered cells is only reported by the first covered cell of its span: the top-left
+			// corner of the intersection between its cells and the region's cells
+			template<typename TGrid> inline bool isReferenceCell(const TGrid& mGrid, const AABB& mShape, int mX, int mY) const noexcept
+			{
+				return std::max(mGrid.getIdx(mShape.getLeft()), startX) == mX && std::max(mGrid.getIdx(mShape.getTop()), startY) == mY;
+			}
+		};
+
+		// Calls `mFn(body)` once for every body passing `mFilter` and overlapping `mRegion`; the filter runs before the body's shape is read
+		template<typename TGrid, typename TFilter, typename TF> inline void forEachInGridRegion(const TGrid& mGrid, const AABB& mRegion, const TFilter& mFilter, const TF& mFn)
+		{
+			const GridRegion range{mGrid, mRegion};
+			if(range.isEmpty()) return;
+
+			for(int iY{range.startY}; iY <= range.endY; ++iY)
+				for(int iX{range.startX}; iX <= range.endX; ++iX)
+					mGrid.forEachBodyAt({iX, iY}, [&](auto* mBody)
+					{
+						if(!mFilter(*mBody)) return;
+
+						const auto& shape(mBody->getShape());
+						if(range.isReferenceCell(mGrid, shape, iX, iY) && shape.isOverlapping(mRegion)) mFn(*mBody);
+					});
+		}
+
+		// Visits the cells of the square rings around the cell containing `mPos`, ring after ring, and calls `mFn(body)` once for every body passing `mFilter`
+		// A body is only visited from the cell of its span closest to the center cell (the first ring reaching it)
+		// Stops once no cell of the next ring can be closer to `mPos` than `mGetBoundSquared()`: cells are at least one cell size wide, so a cell `r` rings away is at least `(r - 1) * cellSize` away
+		template<typename TGrid, typename TBound, typename TFilter, typename TF> inline void forEachInGridRings(const TGrid& mGrid, const Vec2f& mPos,
+			const TBound& mGetBoundSquared, const TFilter& mFilter, const TF& mFn)
+		{
+			const Vec2i center{mGrid.getIdx(Vec2i(mPos))};
+			const int xMin{mGrid.getIdxXMin()}, yMin{mGrid.getIdxYMin()}, xMax{mGrid.getIdxXMax() - 1}, yMax{mGrid.getIdxYMax() - 1};
+			const int maxRadius{std::max({center.x - xMin, xMax - center.x, center.y - yMin, yMax - center.y})};
+			const auto cellSize(ssvu::toFloat(mGrid.getCellSize()));
+
+			auto visitCell([&](int mX, int mY)
+			{
+				if(mX < xMin || mX > xMax || mY < yMin || mY > yMax) return;
+
+				mGrid.forEachBodyAt({mX, mY}, [&](auto* mBody)
+				{
+					if(!mFilter(*mBody)) return;
+
+					const auto& shape(mBody->getShape());
+					const int nearestX{ssvu::getClamped(center.x, mGrid.getIdx(shape.getLeft()), mGrid.getIdx(shape.getRight()))};
+					const int nearestY{ssvu::getClamped(center.y, mGrid.getIdx(shape.getTop()), mGrid.getIdx(shape.getBottom()))};
+					if(nearestX == mX && nearestY == mY) mFn(*mBody);
+				});
+			});
+
+			for(int r{0}; r <= maxRadius; ++r)
+			{
+				const auto minDist(std::max(0.f, (r - 1) * cellSize));
+				if(minDist * minDist > mGetBoundSquared()) return;
+
+				if(r == 0) { visitCell(center.x, center.y); continue; }
+
+				for(int iX{center.x - r}; iX <= center.x + r; ++iX) { visitCell(iX, center.y - r); visitCell(iX, center.y + r); }
+				for(int iY{center.y - r + 1}; iY <= center.y + r - 1; ++iY) { visitCell(center.x - r, iY); visitCell(center.x + r, iY); }
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,150 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_GRID_STATICLAYER
+#define SSVSC_SPATIAL_GRID_STATICLAYER
+
+namespace ssvsc
+{
+	template<typename TW> class Cell;
+
+	namespace Impl
+	{
+		// Read-optimised storage for the static bodies of a grid, rebuilt in one go by `bake`
+		// The rows of all cells are stored back to back in a single array of chunks, compressed sparse row style: a cell only stores
+		// the index of its first chunk and its number of statics, and static bodies are never moved around by insertions nor removals
+		// New (or moved) statics are staged in the dynamic arena until the next `bake`, so that creating a whole level only costs one rebuild
+		// Removed statics are tombstoned in place (null body, empty group mask) until the next `bake` compacts them away
+		template<typename TW> class StaticLayer
+		{
+			public:
+				using BodyType = Body<TW>;
+				using CellType = Cell<TW>;
+				static constexpr std::uint32_t chunkSize{overlapBatchSize};
+				static constexpr SizeT null{ssvu::NumLimits<SizeT>::max()};
+
+			private:
+				struct Chunk { OverlapBatch edges; GroupBatch groups; BodyType* bodies[chunkSize]; };
+
+				std::vector<Chunk> chunks;
+				std::vector<BodyType*> statics;
+				std::vector<CellType*> rowCells;
+				bool dirty{false};
+
+				// Calls `mFn(chunk, count)` for every chunk of the row of `mCell`, where only the first `count` entries of `chunk` are used
+				template<typename TF> inline void forEachChunk(const CellType& mCell, TF mFn) const
+				{
+					const auto end(mCell.staticBegin * chunkSize + mCell.staticCount);
+					for(auto i(mCell.staticBegin * chunkSize); i < end; i += chunkSize) mFn(chunks[i / chunkSize], std::min(end - i, std::uint32_t(chunkSize)));
+				}
+
+			public:
+				// Registers a static body, staged in the dynamic arena until the next `bake`; returns its index, to be passed to `del`
+				inline SizeT add(BodyType* mBody) { dirty = true; statics.emplace_back(mBody); return statics.size() - 1; }
+				inline void del(SizeT mIdx) noexcept
+				{
+					SSVU_ASSERT(mIdx < statics.size());
+
+					dirty = true;
+					statics[mIdx] = statics.back();
+					statics[mIdx]->getSpatialInfo().staticIdx = mIdx;
+					statics.pop_back();
+				}
+
+				// Unregisters every static, leaving the rows empty until the next `bake`; used by `GridBase::rebuild`, which registers them all again
+				inline void clear() noexcept
+				{
+					for(const auto& c : rowCells) c->staticBegin = c->staticCount = 0;
+					rowCells.clear();
+					statics.clear();
+					dirty = true;
+				}
+
+				// Rebuilds the rows from every registered static, moving staged statics out of `mArena`; does nothing if no static was added nor removed since the last call
+				template<typename TArena> inline void bake(TArena& mArena)
+				{
+					if(!dirty) return;
+					dirty = false;
+
+					for(const auto& c : rowCells) c->staticBegin = c->staticCount = 0;
+					rowCells.clear();
+
+					for(const auto& b : statics)
+					{
+						auto& info(b->getSpatialInfo());
+						for(const auto& m : info.memberships)
+						{
+							if(m.cell->staticCount++ == 0) rowCells.emplace_back(m.cell);
+							if(!info.baked) mArena.del(*m.cell, m.slot);
+						}
+						info.baked = true;
+					}
+
+					std::uint32_t chunkCount{0};
+					for(const auto& c : rowCells)
+					{
+						c->staticBegin = chunkCount;
+						chunkCount += (c->staticCount + chunkSize - 1) / chunkSize;
+						c->staticCount = 0;
+					}
+					chunks.resize(chunkCount);
+
+					for(const auto& b : statics)
+						for(auto& m : b->getSpatialInfo().memberships)
+						{
+							const auto idx(m.cell->staticBegin * chunkSize + m.cell->staticCount++);
+							m.slot = {idx / chunkSize, idx % chunkSize};
+
+							auto& chunk(chunks[m.slot.chunk]);
+							chunk.bodies[m.slot.slot] = b;
+							chunk.edges.set(m.slot.slot, b->getShape());
+							chunk.groups.set(m.slot.slot, b->getGroups(), b->getGroupsToCheck());
+						}
+				}
+
+				// Removes a baked entry until the next `bake`: its empty group mask fails every filter, and `forEach` skips it
+				inline void tombstone(const CellSlot& mSlot) noexcept
+				{
+					auto& chunk(chunks[mSlot.chunk]);
+					chunk.bodies[mSlot.slot] = nullptr;
+					chunk.groups.set(mSlot.slot, {}, {});
+				}
+
+				inline void setEdges(const CellSlot& mSlot, const AABB& mShape) noexcept { chunks[mSlot.chunk].edges.set(mSlot.slot, mShape); }
+				inline void setGroups(const CellSlot& mSlot, const GroupBitset& mGroups, const GroupBitset& mGroupsToCheck) noexcept
+				{
+					chunks[mSlot.chunk].groups.set(mSlot.slot, mGroups, mGroupsToCheck);
+				}
+
+				template<typename TF> inline void forEach(const CellType& mCell, TF mFn) const
+				{
+					forEachChunk(mCell, [&mFn](const Chunk& mChunk, std::uint32_t mCount){ for(auto i(0u); i < mCount; ++i) if(mChunk.bodies[i] != nullptr) mFn(mChunk.bodies[i]); });
+				}
+
+				// Same filters as `CellArena::forEachInGroups` and `CellArena::forEachOverlapping`
+				template<typename TF> inline void forEachInGroups(const CellType& mCell, const GroupBitset& mGroups, TF mFn) const
+				{
+					const auto groups(toGroupBits(mGroups));
+					forEachChunk(mCell, [groups, &mFn](const Chunk& mChunk, std::uint32_t mCount)
+					{
+						forEachBit(getGroupMask(mChunk.groups, groups, 0, mCount), [&mChunk, &mFn](std::uint32_t mIdx){ mFn(mChunk.bodies[mIdx]); });
+					});
+				}
+				template<typename TF> inline void forEachOverlapping(const CellType& mCell, const AABB& mShape, const GroupBitset& mGroupsToCheck, const GroupBitset& mGroups, TF mFn) const
+				{
+					const auto groupsToCheck(toGroupBits(mGroupsToCheck)), groups(toGroupBits(mGroups));
+					forEachChunk(mCell, [&mShape, groupsToCheck, groups, &mFn](const Chunk& mChunk, std::uint32_t mCount)
+					{
+						const auto mask(getGroupMask(mChunk.groups, groupsToCheck, groups, mCount));
+						if(mask != 0) forEachBit(mask & getOverlapMask(mShape, mChunk.edges, mCount), [&mChunk, &mFn](std::uint32_t mIdx){ mFn(mChunk.bodies[mIdx]); });
+					});
+				}
+
+				inline SizeT getStaticCount() const noexcept	{ return statics.size(); }
+				inline SizeT getChunkCount() const noexcept		{ return chunks.size(); }
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,250 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_GRID_STATICLEVEL
+#define SSVSC_SPATIAL_GRID_STATICLEVEL
+
+namespace ssvsc
+{
+	// A static body of a level, as passed to `StaticLevel::bake`
+	struct StaticLevelBody
+	{
+		AABB shape;
+		GroupBitset groups, groupsToCheck;
+	};
+
+	namespace Impl
+	{
+		// Sections of a level file start on multiples of this, so that chunks can be loaded with aligned SIMD loads straight from the mapping
+		constexpr SizeT staticLevelAlignment{64};
+		inline SizeT alignStaticLevelOffset(SizeT mOffset) noexcept { return (mOffset + staticLevelAlignment - 1) / staticLevelAlignment * staticLevelAlignment; }
+
+		struct StaticLevelHeader
+		{
+			std::uint32_t magic, version;
+			std::int32_t cols, rows, cellSize, offset;
+			std::uint32_t bodyCount, chunkCount;
+		};
+
+		// Range of a cell in the chunk array, like the rows of `StaticLayer`: `count` entries starting at the first slot of chunk `chunkBegin`
+		struct StaticLevelRow { std::uint32_t chunkBegin, count; };
+
+		struct StaticLevelChunk { OverlapBatch edges; GroupBatch groups; std::uint32_t ids[overlapBatchSize]; };
+
+		struct StaticLevelRecord
+		{
+			std::int32_t x, y, halfWidth, halfHeight;
+			std::uint32_t groups, groupsToCheck;
+		};
+	}
+
+	// Read-only static collision layer over an offline-baked level file, used in place without any parsing nor allocation (see `MappedFile`)
+	// The file stores every body's shape and groups, and a per-cell index of chunks laid out like the rows of `StaticLayer`, for one grid layout
+	// (columns, rows, cell size and offset); it is host byte order, so files must be baked on a machine of the same endianness
+	// Attached to a grid through `World::setStaticLevel`, entries collide with bodies and sensors like static bodies, but are only materialised
+	// as (proxy) bodies the first time something touches them; spatial queries do not see them, use `forEachOverlapping` instead
+	// Construction only checks the header and the size of the data: level files are trusted, call `validate` once to check one in full
+	class StaticLevel
+	{
+		public:
+			static constexpr std::uint32_t magic{0x4C435353}, version{1};
+			static constexpr SizeT chunkSize{Impl::overlapBatchSize};
+
+		private:
+			using Header = Impl::StaticLevelHeader;
+			using Row = Impl::StaticLevelRow;
+			using Chunk = Impl::StaticLevelChunk;
+			using Record = Impl::StaticLevelRecord;
+
+			const Header* header;
+			const Row* rows;
+			const Chunk* chunks;
+			const Record* records;
+
+			struct Layout { SizeT rows, chunks, records, size; };
+			inline static Layout getLayout(SizeT mRowCount, SizeT mChunkCount, SizeT mRecordCount) noexcept
+			{
+				Layout result;
+				result.rows = Impl::alignStaticLevelOffset(sizeof(Header));
+				result.chunks = Impl::alignStaticLevelOffset(result.rows + mRowCount * sizeof(Row));
+				result.records = Impl::alignStaticLevelOffset(result.chunks + mChunkCount * sizeof(Chunk));
+				result.size = result.records + mRecordCount * sizeof(Record);
+				return result;
+			}
+
+			// Layouts are only computed for grids whose rows take at most half the address space, so that the offsets of the sections never wrap
+			inline static bool isRowCountValid(int mCols, int mRows) noexcept
+			{
+				return mCols > 0 && mRows > 0 && SizeT(mCols) <= ssvu::NumLimits<SizeT>::max() / 2 / sizeof(Row) / SizeT(mRows);
+			}
+
+			inline int getIdx(int mValue) const noexcept { return mValue / header->cellSize; }
+			inline bool isIdxValid(int mX, int mY) const noexcept
+			{
+				return mX + header->offset >= 0 && mX + header->offset < header->cols && mY + header->offset >= 0 && mY + header->offset < header->rows;
+			}
+			inline const Row& getRow(int mX, int mY) const noexcept { return rows[ssvu::get1DIdxFrom2D(mX + header->offset, mY + header->offset, header->cols)]; }
+
+			// Calls `mFn(chunk, count)` for every chunk of the row of a cell, where only the first `count` entries of `chunk` are used
+			template<typename TF> inline void forEachChunk(const Row& mRow, TF mFn) const
+			{
+				for(auto i(0u); i < mRow.count; i += chunkSize) mFn(chunks[mRow.chunkBegin + i / chunkSize], std::min(SizeT(mRow.count - i), SizeT(chunkSize)));
+			}
+
+		public:
+			// Writes a level file for a grid of `mCols` * `mRows` cells of `mCellSize` (see `Grid`); body ids are their indices in `mBodies`
+			// Bodies must lie inside the grid, as out of bounds statics never collide
+			inline static void bake(std::vector<char>& mOut, int mCols, int mRows, int mCellSize, int mOffset, const std::vector<StaticLevelBody>& mBodies)
+			{
+				if(!isRowCountValid(mCols, mRows) || mCellSize <= 0) throw std::runtime_error{"ssvsc::StaticLevel::bake: invalid grid layout"};
+				if(mBodies.size() > 0xFFFFFFFFu) throw std::runtime_error{"ssvsc::StaticLevel::bake: too many bodies"};
+
+				auto getCellIdx([mCellSize](int mValue){ return mValue / mCellSize; });
+				auto forEachCell([&](const AABB& mShape, auto mFn)
+				{
+					for(int iX{getCellIdx(mShape.getLeft())}; iX <= getCellIdx(mShape.getRight()); ++iX)
+						for(int iY{getCellIdx(mShape.getTop())}; iY <= getCellIdx(mShape.getBottom()); ++iY) mFn(ssvu::get1DIdxFrom2D(iX + mOffset, iY + mOffset, mCols));
+				});
+
+				const SizeT rowCount(SizeT(mCols) * SizeT(mRows));
+				std::vector<Row> levelRows(rowCount, Row{0, 0});
+
+				for(const auto& b : mBodies)
+				{
+					const auto& s(b.shape);
+					if(getCellIdx(s.getLeft()) + mOffset < 0 || getCellIdx(s.getTop()) + mOffset < 0 || getCellIdx(s.getRight()) + mOffset >= mCols || getCellIdx(s.getBottom()) + mOffset >= mRows)
+						throw std::runtime_error{"ssvsc::StaticLevel::bake: body out of the grid's bounds"};
+
+					forEachCell(s, [&levelRows](SizeT mIdx){ ++levelRows[mIdx].count; });
+				}
+
+				std::uint32_t chunkCount{0};
+				for(auto& r : levelRows)
+				{
+					r.chunkBegin = chunkCount;
+					chunkCount += (r.count + chunkSize - 1) / chunkSize;
+				}
+
+				const auto layout(getLayout(rowCount, chunkCount, mBodies.size()));
+				mOut.assign(layout.size, 0);
+
+				const Header levelHeader{magic, version, mCols, mRows, mCellSize, mOffset, std::uint32_t(mBodies.size()), chunkCount};
+				std::memcpy(mOut.data(), &levelHeader, sizeof(Header));
+				std::memcpy(mOut.data() + layout.rows, levelRows.data(), rowCount * sizeof(Row));
+
+				// Rows are filled in body order, so entries of a cell are sorted by id
+				std::vector<Chunk> levelChunks(chunkCount);
+				std::vector<std::uint32_t> filled(rowCount, 0);
+				for(auto i(0u); i < mBodies.size(); ++i)
+				{
+					const auto& b(mBodies[i]);
+					forEachCell(b.shape, [&](SizeT mIdx)
+					{
+						const auto slot(levelRows[mIdx].chunkBegin * chunkSize + filled[mIdx]++);
+						auto& chunk(levelChunks[slot / chunkSize]);
+						chunk.edges.set(slot % chunkSize, b.shape);
+						chunk.groups.set(slot % chunkSize, b.groups, b.groupsToCheck);
+						chunk.ids[slot % chunkSize] = i;
+					});
+
+					const Record record{b.shape.getX(), b.shape.getY(), b.shape.getHalfWidth(), b.shape.getHalfHeight(), Impl::toGroupBits(b.groups), Impl::toGroupBits(b.groupsToCheck)};
+					std::memcpy(mOut.data() + layout.records + i * sizeof(Record), &record, sizeof(Record));
+				}
+				if(chunkCount > 0) std::memcpy(mOut.data() + layout.chunks, levelChunks.data(), chunkCount * sizeof(Chunk));
+			}
+
+			// `mData` must stay valid (and unchanged) for the lifetime of the level, and be aligned to `Impl::staticLevelAlignment` bytes (mapped files always are)
+			inline StaticLevel(const char* mData, SizeT mSize)
+			{
+				if(reinterpret_cast<std::uintptr_t>(mData) % Impl::staticLevelAlignment != 0) throw std::runtime_error{"ssvsc::StaticLevel: misaligned level data"};
+				if(mSize < sizeof(Header)) throw std::runtime_error{"ssvsc::StaticLevel: truncated level"};
+
+				header = reinterpret_cast<const Header*>(mData);
+				if(header->magic != magic) throw std::runtime_error{"ssvsc::StaticLevel: not a level file"};
+				if(header->version != version) throw std::runtime_error{"ssvsc::StaticLevel: unsupported level version"};
+				if(!isRowCountValid(header->cols, header->rows) || header->cellSize <= 0) throw std::runtime_error{"ssvsc::StaticLevel: invalid grid layout"};
+
+				const auto layout(getLayout(SizeT(header->cols) * SizeT(header->rows), header->chunkCount, header->bodyCount));
+				if(layout.size != mSize) throw std::runtime_error{"ssvsc::StaticLevel: level size mismatch"};
+
+				rows = reinterpret_cast<const Row*>(mData + layout.rows);
+				chunks = reinterpret_cast<const Chunk*>(mData + layout.chunks);
+				records = reinterpret_cast<const Record*>(mData + layout.records);
+			}
+
+			// Checks every row and entry of the level, throwing `std::runtime_error` on the first inconsistency; linear in the size of the level
+			inline void validate() const
+			{
+				if(!isRowCountValid(header->cols, header->rows)) throw std::runtime_error{"ssvsc::StaticLevel::validate: invalid grid layout"};
+
+				const SizeT rowCount(SizeT(header->cols) * SizeT(header->rows));
+				for(auto i(0u); i < rowCount; ++i)
+				{
+					const auto& r(rows[i]);
+					if(SizeT(r.chunkBegin) + (SizeT(r.count) + chunkSize - 1) / chunkSize > header->chunkCount)
+						throw std::runtime_error{"ssvsc::StaticLevel::validate: row out of the chunk array"};
+
+					forEachChunk(r, [this](const Chunk& mChunk, SizeT mCount)
+					{
+						for(auto j(0u); j < mCount; ++j)
+							if(mChunk.ids[j] >= header->bodyCount) throw std::runtime_error{"ssvsc::StaticLevel::validate: invalid body id"};
+					});
+				}
+
+				for(auto i(0u); i < header->bodyCount; ++i)
+					if(records[i].halfWidth < 0 || records[i].halfHeight < 0) throw std::runtime_error{"ssvsc::StaticLevel::validate: invalid body shape"};
+			}
+
+			// Same filters as `StaticLayer::forEachOverlapping`, over the entries of the cell at `mX`, `mY`: calls `mFn(id)`
+			template<typename TF> inline void forEachOverlapping(int mX, int mY, const AABB& mShape, const GroupBitset& mGroupsToCheck, const GroupBitset& mGroups, TF mFn) const
+			{
+				if(!isIdxValid(mX, mY)) return;
+
+				const auto groupsToCheck(Impl::toGroupBits(mGroupsToCheck)), groups(Impl::toGroupBits(mGroups));
+				forEachChunk(getRow(mX, mY), [&mShape, groupsToCheck, groups, &mFn](const Chunk& mChunk, SizeT mCount)
+				{
+					const auto mask(Impl::getGroupMask(mChunk.groups, groupsToCheck, groups, mCount));
+					if(mask != 0) Impl::forEachBit(mask & Impl::getOverlapMask(mShape, mChunk.edges, mCount), [&mChunk, &mFn](std::uint32_t mIdx){ mFn(mChunk.ids[mIdx]); });
+				});
+			}
+
+			// Calls `mFn(id)` once for every entry overlapping `mRegion`; thread-safe, as it never materialises bodies
+			template<typename TF> inline void forEachOverlapping(const AABB& mRegion, TF mFn) const
+			{
+				const int startX{std::max(getIdx(mRegion.getLeft()), -header->offset)}, startY{std::max(getIdx(mRegion.getTop()), -header->offset)};
+				const int endX{std::min(getIdx(mRegion.getRight()), header->cols - header->offset - 1)}, endY{std::min(getIdx(mRegion.getBottom()), header->rows - header->offset - 1)};
+
+				for(int iX{startX}; iX <= endX; ++iX)
+					for(int iY{startY}; iY <= endY; ++iY)
+						forEachChunk(getRow(iX, iY), [&](const Chunk& mChunk, SizeT mCount)
+						{
+							Impl::forEachBit(Impl::getOverlapMask(mRegion, mChunk.edges, mCount), [&](std::uint32_t mIdx)
+							{
+								// Entries spanning several cells are only reported in the first cell they share with the region
+								const auto id(mChunk.ids[mIdx]);
+								const auto& s(getShape(id));
+								if(std::max(getIdx(s.getLeft()), startX) == iX && std::max(getIdx(s.getTop()), startY) == iY) mFn(id);
+							});
+						});
+			}
+
+			inline AABB getShape(std::uint32_t mId) const noexcept
+			{
+				SSVU_ASSERT(mId < header->bodyCount);
+				const auto& r(records[mId]);
+				return {Vec2i{r.x, r.y}, Vec2i{r.halfWidth, r.halfHeight}};
+			}
+			inline GroupBitset getGroups(std::uint32_t mId) const noexcept			{ SSVU_ASSERT(mId < header->bodyCount); return GroupBitset{records[mId].groups}; }
+			inline GroupBitset getGroupsToCheck(std::uint32_t mId) const noexcept	{ SSVU_ASSERT(mId < header->bodyCount); return GroupBitset{records[mId].groupsToCheck}; }
+
+			inline SizeT getBodyCount() const noexcept	{ return header->bodyCount; }
+			inline SizeT getChunkCount() const noexcept	{ return header->chunkCount; }
+			inline int getColumns() const noexcept		{ return header->cols; }
+			inline int getRows() const noexcept			{ return header->rows; }
+			inline int getCellSize() const noexcept		{ return header->cellSize; }
+			inline int getOffset() const noexcept		{ return header->offset; }
+	};
+}
+
+#endif
@@ -0,0 +1,175 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_REBUILDGRID
+#define SSVSC_SPATIAL_REBUILDGRID
+
+#include "SSVSCollision/Spatial/RebuildGrid/RebuildGridInfo.hpp"
+
+namespace ssvsc
+{
+	// Grid whose cells are rebuilt from scratch every frame, after bodies have integrated, with a counting sort into one flat array
+	// Meant for scenes where almost every body moves every frame (particles, projectiles), where incremental cell updates are wasted work
+	// Queries between updates see the cells of the last rebuild, which does not account for the last resolution offsets
+	template<typename TW> class RebuildGrid
+	{
+		public:
+			using BodyType = Body<TW>;
+			using SpatialInfoType = RebuildGridInfo<TW>;
+			using CellType = SizeT;
+			friend SpatialInfoType;
+
+			static constexpr SizeT nullCell{ssvu::NumLimits<SizeT>::max()};
+
+		private:
+			struct Entry { BodyType* body; int startX, startY, endX, endY; bool valid; };
+
+			std::vector<Entry> entries;
+			std::vector<std::uint32_t> cellStarts, cursors;
+			std::vector<BodyType*> cellBodies;
+			int cols, rows, cellSize, offset, paint{0};
+
+			inline void add(SpatialInfoType& mInfo)
+			{
+				SSVU_ASSERT(mInfo.entry == SpatialInfoType::null);
+				mInfo.entry = entries.size();
+				entries.push_back({&ssvu::castUp<BodyType>(mInfo.base), 0, 0, -1, -1, false});
+			}
+			inline void del(SpatialInfoType& mInfo)
+			{
+				SSVU_ASSERT(mInfo.entry != SpatialInfoType::null);
+
+				// The body is about to be freed: its pointers must not survive in the cells until the next rebuild
+				const auto& e(entries[mInfo.entry]);
+				if(e.valid)
+					for(int iY{e.startY}; iY <= e.endY; ++iY)
+						for(int iX{e.startX}; iX <= e.endX; ++iX)
+						{
+							const auto idx(getCellIdx(iX, iY));
+							for(auto i(cellStarts[idx]); i < cellStarts[idx + 1]; ++i) if(cellBodies[i] == e.body) cellBodies[i] = nullptr;
+						}
+
+				entries[mInfo.entry] = entries.back();
+				entries[mInfo.entry].body->getSpatialInfo().entry = mInfo.entry;
+				entries.pop_back();
+				mInfo.entry = SpatialInfoType::null;
+			}
+
+			inline SizeT getCellIdx(int mX, int mY) const noexcept { return ssvu::get1DIdxFrom2D(mX + offset, mY + offset, cols); }
+
+			template<typename TF> inline void forEachInRange(int mStartX, int mStartY, int mEndX, int mEndY, TF mFn)
+			{
+				++paint;
+
+				for(int iY{mStartY}; iY <= mEndY; ++iY)
+					for(int iX{mStartX}; iX <= mEndX; ++iX)
+					{
+						const auto idx(getCellIdx(iX, iY));
+						for(auto i(cellStarts[idx]); i < cellStarts[idx + 1]; ++i)
+						{
+							if(cellBodies[i] == nullptr) continue;
+
+							auto& info(cellBodies[i]->getSpatialInfo());
+							if(info.paint == paint) continue;
+
+							info.paint = paint;
+							mFn(cellBodies[i]);
+						}
+					}
+			}
+
+		public:
+			inline RebuildGrid(int mCols, int mRows, int mCellSize, int mOffset = 0) : cols{mCols}, rows{mRows}, cellSize{mCellSize}, offset{mOffset}
+			{
+				cellStarts.resize(cols * rows + 1);
+			}
+
+			// Rebuilds every cell: bodies compute their cell ranges in parallel through `mRun(count, fn)`, then get counted and
+			// scattered serially, so that each cell lists its bodies in registration order and detection stays deterministic
+			template<typename TRunner> inline void refresh(TRunner mRun)
+			{
+				auto calcRange([this](SizeT mIdx)
+				{
+					auto& e(entries[mIdx]);
+					const auto& shape(e.body->getShape());
+
+					e.startX = getIdx(shape.getLeft());
+					e.startY = getIdx(shape.getTop());
+					e.endX = getIdx(shape.getRight());
+					e.endY = getIdx(shape.getBottom());
+					e.valid = isIdxValid(e.startX, e.startY, e.endX, e.endY);
+
+					if(!e.valid) e.body->setOutOfBounds(true);
+				});
+				mRun(entries.size(), calcRange);
+
+				std::fill(std::begin(cellStarts), std::end(cellStarts), 0);
+				for(const auto& e : entries)
+				{
+					if(!e.valid) continue;
+
+					for(int iY{e.startY}; iY <= e.endY; ++iY)
+						for(int iX{e.startX}; iX <= e.endX; ++iX) ++cellStarts[getCellIdx(iX, iY) + 1];
+				}
+
+				for(auto i(1u); i < cellStarts.size(); ++i) cellStarts[i] += cellStarts[i - 1];
+
+				cursors.assign(std::begin(cellStarts), std::end(cellStarts) - 1);
+				cellBodies.resize(cellStarts.back());
+				for(const auto& e : entries)
+				{
+					if(!e.valid) continue;
+
+					for(int iY{e.startY}; iY <= e.endY; ++iY)
+						for(int iX{e.startX}; iX <= e.endX; ++iX) cellBodies[cursors[getCellIdx(iX, iY)]++] = e.body;
+				}
+			}
+
+			inline int getIdxXMin() const noexcept	{ return 0 - offset; }
+			inline int getIdxYMin() const noexcept	{ return 0 - offset; }
+			inline int getIdxXMax() const noexcept	{ return cols - offset; }
+			inline int getIdxYMax() const noexcept	{ return rows - offset; }
+			inline int getRows() const noexcept		{ return rows; }
+			inline int getColumns() const noexcept	{ return cols; }
+			inline int getOffset() const noexcept	{ return offset; }
+			inline int getCellSize() const noexcept	{ return cellSize; }
+
+			inline int getIdx(int mValue) const noexcept			{ SSVU_ASSERT(cellSize != 0); return mValue / cellSize; }
+			inline Vec2i getIdx(const Vec2i& mPos) const noexcept	{ return {getIdx(mPos.x), getIdx(mPos.y)}; }
+
+			// Cells are plain indices into the flat arrays; out of bounds indices map to `nullCell`, which holds no bodies
+			inline CellType getCell(int mX, int mY) const noexcept		{ return isIdxValid({mX, mY}) ? getCellIdx(mX, mY) : nullCell; }
+			inline CellType getCell(const Vec2i& mIdx) const noexcept	{ return getCell(mIdx.x, mIdx.y); }
+
+			template<typename TF> inline void forEachBody(CellType mCell, TF mFn) const
+			{
+				if(mCell == nullCell) return;
+				for(auto i(cellStarts[mCell]); i < cellStarts[mCell + 1]; ++i) if(cellBodies[i] != nullptr) mFn(cellBodies[i]);
+			}
+
+			template<typename TF> inline void forEachBodyAt(const Vec2i& mIdx, TF mFn) const { forEachBody(getCell(mIdx), mFn); }
+			template<typename TF> inline void forEachBodyInGroupsAt(const Vec2i& mIdx, const GroupBitset& mGroups, TF mFn) const
+			{
+				forEachBody(getCell(mIdx), [&mGroups, &mFn](BodyType* mBody){ if(mBody->hasAnyGroup(mGroups)) mFn(mBody); });
+			}
+			template<typename TFilter, typename TF> inline void forEachOverlapping(const AABB& mRegion, const TFilter& mFilter, const TF& mFn) const
+			{
+				Impl::forEachInGridRegion(*this, mRegion, mFilter, mFn);
+			}
+			template<typename TBound, typename TFilter, typename TF> inline void forEachNear(const Vec2f& mPos, const TBound& mGetBoundSquared, const TFilter& mFilter, const TF& mFn) const
+			{
+				Impl::forEachInGridRings(*this, mPos, mGetBoundSquared, mFilter, mFn);
+			}
+
+			inline bool isIdxValid(const Vec2i& mIdx) const noexcept					{ return mIdx.x >= getIdxXMin() && mIdx.x < getIdxXMax() && mIdx.y >= getIdxYMin() && mIdx.y < getIdxYMax(); }
+			inline bool isIdxValid(int mX1, int mY1, int mX2, int mY2) const noexcept	{ return mX1 >= getIdxXMin() && mX2 < getIdxXMax() && mY1 >= getIdxYMin() && mY2 < getIdxYMax(); }
+	};
+
+	namespace Impl
+	{
+		template<typename TW> struct SpatialTraits<RebuildGrid<TW>> { static constexpr bool rebuildsEachFrame{true}, bakesStatics{false}, rebuildsInBulk{false}, hasStaticLevels{false}, joinsInBulk{false}; };
+	}
+}
+
+#endif
@@ -0,0 +1,62 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_REBUILDGRIDINFO
+#define SSVSC_SPATIAL_REBUILDGRIDINFO
+
+namespace ssvsc
+{
+	template<typename TW> class RebuildGridInfo
+	{
+		public:
+			using SpatialType = typename TW::SpatialType;
+			using BaseType = Base<TW>;
+			using BodyType = Body<TW>;
+			using SensorType = Sensor<TW>;
+			friend SpatialType;
+
+			static constexpr SizeT null{ssvu::NumLimits<SizeT>::max()};
+
+		private:
+			SpatialType& grid;
+			BaseType& base;
+			SizeT entry{null};
+			int paint{-1};
+
+			inline const AABB& getShapeImpl(BodyTag) const noexcept		{ return ssvu::castUp<BodyType>(base).getShape(); }
+			inline const AABB& getShapeImpl(SensorTag) const noexcept	{ return ssvu::castUp<SensorType>(base).getShape(); }
+			inline void handleCollisionImpl(FT mFT, BodyType* mBody, BodyTag) const noexcept	{ SSVU_ASSERT(mBody != nullptr); ssvu::castUp<BodyType>(base).handleCollision(mFT, mBody); }
+			inline void handleCollisionImpl(FT mFT, BodyType* mBody, SensorTag) const noexcept	{ SSVU_ASSERT(mBody != nullptr); ssvu::castUp<SensorType>(base).handleCollision(mFT, mBody); }
+
+			// Only bodies are registered in the grid: sensors look up the cells under their shape
+			inline void registerImpl(BodyTag)	{ grid.add(*this); }
+			inline void registerImpl(SensorTag)	{ }
+			inline void unregisterImpl(BodyTag)	{ if(entry != null) grid.del(*this); }
+			inline void unregisterImpl(SensorTag) { }
+
+		public:
+			inline RebuildGridInfo(SpatialType& mGrid, BaseType& mBase) noexcept : grid(mGrid), base(mBase) { }
+
+			template<typename TTag> inline void init()		{ registerImpl(TTag{}); }
+			inline void invalidate() noexcept				{ }
+			template<typename TTag> inline void preUpdate()	{ }
+			template<typename TTag> inline void postUpdate() const noexcept	{ }
+			template<typename TTag> inline void refreshGroups() const noexcept	{ }
+			template<typename TTag> inline void destroy()	{ unregisterImpl(TTag{}); }
+			template<typename TTag> inline void handleCollisions(FT mFT)
+			{
+				const auto& shape(getShapeImpl(TTag{}));
+				const int startX{grid.getIdx(shape.getLeft())}, startY{grid.getIdx(shape.getTop())};
+				const int endX{grid.getIdx(shape.getRight())}, endY{grid.getIdx(shape.getBottom())};
+
+				// Like other grids, out of bounds objects do not collide; bodies were already flagged by the rebuild
+				if(!grid.isIdxValid(startX, startY, endX, endY)) return;
+				SSVSC_STATS_COUNT(base.getWorld(), cellsVisited, (endX - startX + 1) * (endY - startY + 1));
+
+				grid.forEachInRange(startX, startY, endX, endY, [this, mFT](BodyType* mBody){ handleCollisionImpl(mFT, mBody, TTag{}); });
+			}
+	};
+}
+
+#endif
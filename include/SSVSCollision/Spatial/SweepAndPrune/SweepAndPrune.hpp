@@ -0,0 +1,217 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_SWEEPANDPRUNE
+#define SSVSC_SPATIAL_SWEEPANDPRUNE
+
+#include "SSVSCollision/Spatial/SweepAndPrune/SweepAndPruneInfo.hpp"
+
+namespace ssvsc
+{
+	// Broadphase keeping sorted endpoint lists on both axes
+	// Endpoints are moved with insertion sort as shapes change, so coherent frames cost little;
+	// every swap between a min and a max endpoint updates the set of overlapping pairs
+	// Added shapes wait in a pending list, and removed ones leave dead endpoints behind: both are applied together (see `flush`) right before
+	// the lists are sorted or read again, so that bulk insertion and removal cost a sort of the batch and one merge pass per axis; the world
+	// joins all the bodies created since its last update before stepping any of them, so that they end up in a single batch
+	template<typename TW> class SweepAndPrune
+	{
+		public:
+			using SpatialInfoType = SweepAndPruneInfo<TW>;
+			friend SpatialInfoType;
+
+			// Endpoints of removed shapes have a null owner until the next `flush`
+			struct Endpoint
+			{
+				SpatialInfoType* owner;
+				int value;
+				bool isMax;
+			};
+
+		private:
+			std::vector<Endpoint> axes[2];
+			std::vector<SpatialInfoType*> pending, activeAll, activeNew;
+			std::vector<Endpoint> added, merged;
+			SizeT deadCount{0};
+
+			// On equal values a max comes before a min: touching shapes are not overlapping
+			inline static bool isBefore(const Endpoint& mA, const Endpoint& mB) noexcept { return mA.value < mB.value || (mA.value == mB.value && mA.isMax && !mB.isMax); }
+
+			inline void setIdx(SizeT mAxis, SizeT mIdx) noexcept
+			{
+				const auto& e(axes[mAxis][mIdx]);
+				(e.isMax ? e.owner->maxIdxs : e.owner->minIdxs)[mAxis] = mIdx;
+			}
+
+			// Swaps the endpoints at `mIdx` and `mIdx + 1`, the right one moving left
+			inline void swapEndpoints(SizeT mAxis, SizeT mIdx)
+			{
+				auto& axis(axes[mAxis]);
+				auto& l(axis[mIdx]);
+				auto& r(axis[mIdx + 1]);
+
+				if(l.owner != r.owner)
+				{
+					if(!r.isMax && l.isMax) { if(l.owner->isOverlapping(*r.owner)) l.owner->addOverlap(*r.owner); }
+					else if(r.isMax && !l.isMax) l.owner->delOverlap(*r.owner);
+				}
+
+				std::swap(l, r);
+				setIdx(mAxis, mIdx);
+				setIdx(mAxis, mIdx + 1);
+			}
+
+			inline void sortEndpoint(SizeT mAxis, SizeT mIdx)
+			{
+				auto& axis(axes[mAxis]);
+				while(mIdx > 0 && isBefore(axis[mIdx], axis[mIdx - 1])) swapEndpoints(mAxis, --mIdx);
+				while(mIdx + 1 < axis.size() && isBefore(axis[mIdx + 1], axis[mIdx])) swapEndpoints(mAxis, mIdx++);
+			}
+
+			// Merges the sorted endpoints of the pending shapes into an axis, dropping the dead endpoints; on equal keys, endpoints already in the
+			// axis come first, then pending ones in the order they were added, as if they had been inserted one by one
+			inline void mergeAxis(SizeT mAxis)
+			{
+				added.clear();
+				for(const auto& p : pending)
+				{
+					if(p == nullptr) continue;
+					added.emplace_back(Endpoint{p, p->mins[mAxis], false});
+					added.emplace_back(Endpoint{p, p->maxs[mAxis], true});
+				}
+				std::stable_sort(std::begin(added), std::end(added), isBefore);
+
+				auto& axis(axes[mAxis]);
+				merged.clear();
+				merged.reserve(axis.size() - deadCount * 2 + added.size());
+
+				auto i(std::begin(added));
+				for(const auto& e : axis)
+				{
+					if(e.owner == nullptr) continue;
+					for(; i != std::end(added) && isBefore(*i, e); ++i) merged.emplace_back(*i);
+					merged.emplace_back(e);
+				}
+				merged.insert(std::end(merged), i, std::end(added));
+
+				axis.swap(merged);
+				for(SizeT j{0}; j < axis.size(); ++j) setIdx(mAxis, j);
+			}
+
+			// Finds the overlaps of the pending shapes in a single sweep over the merged X axis: shapes whose min endpoint is reached are checked
+			// against the open shapes, only the new ones if they were already in the axis; closed shapes are dropped from the open lists lazily
+			inline void findNewOverlaps()
+			{
+				activeAll.clear();
+				activeNew.clear();
+
+				auto checkOpen([](std::vector<SpatialInfoType*>& mOpen, SpatialInfoType& mInfo)
+				{
+					ssvu::eraseRemoveIf(mOpen, [&mInfo](SpatialInfoType* mX)
+					{
+						if(!mX->open) return true;
+						if(mInfo.isOverlapping(*mX)) mInfo.addOverlap(*mX);
+						return false;
+					});
+				});
+
+				for(const auto& e : axes[0])
+				{
+					auto& info(*e.owner);
+					if(e.isMax) { info.open = false; continue; }
+
+					checkOpen(info.pending ? activeAll : activeNew, info);
+					info.open = true;
+					activeAll.emplace_back(&info);
+					if(info.pending) activeNew.emplace_back(&info);
+				}
+			}
+
+			// Applies the pending additions and removals; the sort insertions and swaps rely on every endpoint being live and in place
+			inline void flush()
+			{
+				if(pending.empty() && deadCount == 0) return;
+
+				for(SizeT a{0}; a < 2; ++a) mergeAxis(a);
+				deadCount = 0;
+
+				if(!pending.empty())
+				{
+					findNewOverlaps();
+					for(const auto& p : pending) if(p != nullptr) p->pending = false;
+					pending.clear();
+				}
+			}
+
+			inline void add(SpatialInfoType& mInfo)
+			{
+				mInfo.pending = true;
+				mInfo.pendingIdx = pending.size();
+				pending.emplace_back(&mInfo);
+			}
+			inline void update(SpatialInfoType& mInfo)
+			{
+				flush();
+
+				for(SizeT a{0}; a < 2; ++a)
+				{
+					// The endpoint moving outwards goes first, so that neither gets stuck behind the other
+					auto& maxValue(axes[a][mInfo.maxIdxs[a]].value);
+					const bool maxFirst{mInfo.maxs[a] > maxValue};
+
+					if(maxFirst) { maxValue = mInfo.maxs[a]; sortEndpoint(a, mInfo.maxIdxs[a]); }
+					axes[a][mInfo.minIdxs[a]].value = mInfo.mins[a];
+					sortEndpoint(a, mInfo.minIdxs[a]);
+					if(!maxFirst) { axes[a][mInfo.maxIdxs[a]].value = mInfo.maxs[a]; sortEndpoint(a, mInfo.maxIdxs[a]); }
+				}
+			}
+			inline void del(SpatialInfoType& mInfo)
+			{
+				if(mInfo.pending)
+				{
+					pending[mInfo.pendingIdx] = nullptr;
+					mInfo.pending = false;
+					return;
+				}
+
+				for(SizeT a{0}; a < 2; ++a) axes[a][mInfo.minIdxs[a]].owner = axes[a][mInfo.maxIdxs[a]].owner = nullptr;
+				++deadCount;
+
+				while(!mInfo.overlaps.empty()) mInfo.delOverlap(*mInfo.overlaps.back());
+			}
+
+		public:
+			// Scans the X endpoints up to the region's right edge: cost grows with the number of bodies to the left of the region
+			// Shapes still pending are checked one by one, after the others
+			template<typename TFilter, typename TF> inline void forEachOverlapping(const AABB& mRegion, const TFilter& mFilter, const TF& mFn) const
+			{
+				auto visit([&mRegion, &mFilter, &mFn](const SpatialInfoType& mInfo)
+				{
+					if(mInfo.sensor) return;
+
+					auto& body(ssvu::castUp<Body<TW>>(mInfo.base));
+					if(mFilter(body) && body.getShape().isOverlapping(mRegion)) mFn(body);
+				});
+
+				for(const auto& e : axes[0])
+				{
+					if(e.value >= mRegion.getRight()) break;
+					if(!e.isMax && e.owner != nullptr) visit(*e.owner);
+				}
+
+				for(const auto& p : pending) if(p != nullptr) visit(*p);
+			}
+
+			// Pending additions and removals are applied first
+			inline const auto& getEndpointsX() { flush(); return axes[0]; }
+			inline const auto& getEndpointsY() { flush(); return axes[1]; }
+	};
+
+	namespace Impl
+	{
+		template<typename TW> struct SpatialTraits<SweepAndPrune<TW>> { static constexpr bool rebuildsEachFrame{false}, bakesStatics{false}, rebuildsInBulk{false}, hasStaticLevels{false}, joinsInBulk{true}; };
+	}
+}
+
+#endif
@@ -0,0 +1,97 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_SPATIAL_SWEEPANDPRUNEINFO
+#define SSVSC_SPATIAL_SWEEPANDPRUNEINFO
+
+namespace ssvsc
+{
+	template<typename TW> class SweepAndPruneInfo
+	{
+		public:
+			using SpatialType = typename TW::SpatialType;
+			using BaseType = Base<TW>;
+			using BodyType = Body<TW>;
+			using SensorType = Sensor<TW>;
+			friend SpatialType;
+
+		private:
+			SpatialType& sap;
+			BaseType& base;
+
+			std::vector<SweepAndPruneInfo*> overlaps;
+			SizeT minIdxs[2], maxIdxs[2], pendingIdx{0};
+			int mins[2], maxs[2];
+			bool registered{false}, sensor{false}, pending{false}, open{false};
+
+			inline const AABB& getShapeImpl(BodyTag) const noexcept		{ return ssvu::castUp<BodyType>(base).getShape(); }
+			inline const AABB& getShapeImpl(SensorTag) const noexcept	{ return ssvu::castUp<SensorType>(base).getShape(); }
+			inline void handleCollisionImpl(FT mFT, BodyType* mBody, BodyTag) const noexcept	{ SSVU_ASSERT(mBody != nullptr); ssvu::castUp<BodyType>(base).handleCollision(mFT, mBody); }
+			inline void handleCollisionImpl(FT mFT, BodyType* mBody, SensorTag) const noexcept	{ SSVU_ASSERT(mBody != nullptr); ssvu::castUp<SensorType>(base).handleCollision(mFT, mBody); }
+
+			inline bool isOverlapping(const SweepAndPruneInfo& mX) const noexcept
+			{
+				return mins[0] < mX.maxs[0] && mX.mins[0] < maxs[0] && mins[1] < mX.maxs[1] && mX.mins[1] < maxs[1];
+			}
+			inline void addOverlap(SweepAndPruneInfo& mX)
+			{
+				if(ssvu::contains(overlaps, &mX)) return;
+				overlaps.emplace_back(&mX);
+				mX.overlaps.emplace_back(this);
+			}
+			inline void delOverlap(SweepAndPruneInfo& mX)
+			{
+				ssvu::eraseRemove(overlaps, &mX);
+				ssvu::eraseRemove(mX.overlaps, this);
+			}
+
+			// Returns true if the shape's edges differ from the ones stored in the endpoint lists
+			template<typename TTag> inline bool calcEdges()
+			{
+				const auto& shape(getShapeImpl(TTag{}));
+				const int newMins[2]{shape.getLeft(), shape.getTop()}, newMaxs[2]{shape.getRight(), shape.getBottom()};
+
+				if(registered && newMins[0] == mins[0] && newMins[1] == mins[1] && newMaxs[0] == maxs[0] && newMaxs[1] == maxs[1]) return false;
+
+				for(SizeT a{0}; a < 2; ++a) { mins[a] = newMins[a]; maxs[a] = newMaxs[a]; }
+				return true;
+			}
+
+		public:
+			inline SweepAndPruneInfo(SpatialType& mSAP, BaseType& mBase) noexcept : sap(mSAP), base(mBase) { }
+
+			template<typename TTag> inline void init() { preUpdate<TTag>(); }
+			inline void invalidate() noexcept { }
+			template<typename TTag> inline void preUpdate()
+			{
+				// Endpoints are synced every frame: the insertion sort only pays for actual movement
+				if(!calcEdges<TTag>()) return;
+
+				if(registered) { sap.update(*this); return; }
+
+				sensor = std::is_same<TTag, SensorTag>::value;
+				registered = true;
+				sap.add(*this);
+			}
+			template<typename TTag> inline void postUpdate() const noexcept { }
+			template<typename TTag> inline void refreshGroups() const noexcept { }
+			template<typename TTag> inline void destroy()
+			{
+				if(!registered) return;
+
+				sap.del(*this);
+				registered = false;
+			}
+			template<typename TTag> inline void handleCollisions(FT mFT)
+			{
+				sap.flush();
+				for(const auto& o : overlaps)
+					if(!o->sensor) handleCollisionImpl(mFT, &ssvu::castUp<BodyType>(o->base), TTag{});
+			}
+
+			inline const auto& getOverlaps() const noexcept { return overlaps; }
+	};
+}
+
+#endif
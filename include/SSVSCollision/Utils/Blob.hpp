@@ -0,0 +1,70 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_UTILS_BLOB
+#define SSVSC_UTILS_BLOB
+
+namespace ssvsc
+{
+	namespace Impl
+	{
+		// Appends trivially copyable values to a byte buffer, in host byte order and without padding
+		// Values are taken by copy, so that constants (e.g. format magic numbers) can be written without being odr-used
+		class BlobWriter
+		{
+			private:
+				std::vector<char>& data;
+
+			public:
+				inline BlobWriter(std::vector<char>& mData) noexcept : data(mData) { }
+
+				template<typename T> inline void write(T mValue)
+				{
+					static_assert(std::is_trivially_copyable<T>::value, "Blobs only store trivially copyable values");
+
+					const auto offset(data.size());
+					data.resize(offset + sizeof(T));
+					std::memcpy(data.data() + offset, &mValue, sizeof(T));
+				}
+				inline void write(const AABB& mShape) { write(mShape.getPosition()); write(mShape.getHalfSize()); }
+				inline void write(const GroupBitset& mGroups) { write(toGroupBits(mGroups)); }
+		};
+
+		// Reads back the values of a `BlobWriter`, in the same order; throws `std::runtime_error` when reading past the end
+		class BlobReader
+		{
+			private:
+				const char* data;
+				SizeT size, pos{0};
+
+			public:
+				inline BlobReader(const char* mData, SizeT mSize) noexcept : data{mData}, size{mSize} { }
+
+				template<typename T> inline T read()
+				{
+					static_assert(std::is_trivially_copyable<T>::value, "Blobs only store trivially copyable values");
+					if(size - pos < sizeof(T)) throw std::runtime_error{"ssvsc::Impl::BlobReader::read: truncated blob"};
+
+					T result;
+					std::memcpy(&result, data + pos, sizeof(T));
+					pos += sizeof(T);
+					return result;
+				}
+
+				// Reads an item count, checking that the rest of the blob can hold that many items of (at least) `mItemSize` bytes before anything gets allocated for them
+				inline SizeT readCount(SizeT mItemSize)
+				{
+					const auto count(read<std::uint64_t>());
+					if(count > (size - pos) / mItemSize) throw std::runtime_error{"ssvsc::Impl::BlobReader::readCount: truncated blob"};
+					return static_cast<SizeT>(count);
+				}
+				inline AABB readShape()			{ const auto position(read<Vec2i>()); return {position, read<Vec2i>()}; }
+				inline GroupBitset readGroups()	{ return GroupBitset{read<std::uint32_t>()}; }
+
+				inline bool isAtEnd() const noexcept { return pos == size; }
+		};
+	}
+}
+
+#endif
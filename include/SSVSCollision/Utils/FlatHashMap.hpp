@@ -0,0 +1,151 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_UTILS_FLATHASHMAP
+#define SSVSC_UTILS_FLATHASHMAP
+
+namespace ssvsc
+{
+	namespace Impl
+	{
+		// Integer hash with full avalanche (64-bit MurmurHash3 finalizer), so that neighbouring keys do not end up in neighbouring slots
+		struct MixHash
+		{
+			template<typename T> inline SizeT operator()(const T& mKey) const noexcept
+			{
+				auto x(static_cast<std::uint64_t>(mKey));
+				x ^= x >> 33; x *= 0xff51afd7ed558ccdull;
+				x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ull;
+				x ^= x >> 33;
+				return static_cast<SizeT>(x);
+			}
+		};
+
+		// Open-addressing hash map with linear probing, storing keys and values in flat arrays
+		// Deletion shifts the following entries of the probe sequence back instead of leaving tombstones
+		// Values are moved around on insertion and deletion: do not keep references to them across modifications
+		template<typename TKey, typename TValue, typename THash = MixHash> class FlatHashMap
+		{
+			private:
+				static constexpr SizeT minCapacity{16};
+
+				std::vector<TKey> keys;
+				std::vector<TValue> values;
+				std::vector<std::uint8_t> used;
+				SizeT count{0}, mask{0};
+				THash hash;
+
+				inline SizeT getHome(const TKey& mKey) const noexcept { return hash(mKey) & mask; }
+
+				inline SizeT findSlot(const TKey& mKey) const noexcept
+				{
+					if(count == 0) return null;
+
+					for(auto i(getHome(mKey)); used[i]; i = (i + 1) & mask) if(keys[i] == mKey) return i;
+					return null;
+				}
+
+				inline void rehash(SizeT mCapacity)
+				{
+					auto oldKeys(std::move(keys));
+					auto oldValues(std::move(values));
+					auto oldUsed(std::move(used));
+
+					keys.clear(); keys.resize(mCapacity);
+					values.clear(); values.resize(mCapacity);
+					used.assign(mCapacity, 0);
+					mask = mCapacity - 1;
+
+					for(auto i(0u); i < oldUsed.size(); ++i)
+					{
+						if(!oldUsed[i]) continue;
+
+						auto j(getHome(oldKeys[i]));
+						while(used[j]) j = (j + 1) & mask;
+
+						keys[j] = std::move(oldKeys[i]);
+						values[j] = std::move(oldValues[i]);
+						used[j] = 1;
+					}
+				}
+
+				inline void eraseSlot(SizeT mSlot)
+				{
+					// Backward-shift: move every following entry that would still be reachable from its home slot into the hole
+					auto hole(mSlot);
+					for(auto i((mSlot + 1) & mask); used[i]; i = (i + 1) & mask)
+					{
+						const auto home(getHome(keys[i]));
+						if(((i - home) & mask) < ((i - hole) & mask)) continue;
+
+						keys[hole] = std::move(keys[i]);
+						values[hole] = std::move(values[i]);
+						hole = i;
+					}
+
+					used[hole] = 0;
+					values[hole] = TValue{};
+					--count;
+				}
+
+			public:
+				static constexpr SizeT null{ssvu::NumLimits<SizeT>::max()};
+
+				inline TValue* find(const TKey& mKey) noexcept				{ const auto slot(findSlot(mKey)); return slot == null ? nullptr : &values[slot]; }
+				inline const TValue* find(const TKey& mKey) const noexcept	{ const auto slot(findSlot(mKey)); return slot == null ? nullptr : &values[slot]; }
+
+				// Returns the value mapped to `mKey`, inserting a default-constructed one if missing
+				inline TValue& operator[](const TKey& mKey)
+				{
+					// Keep the load factor at or below 1/2
+					if((count + 1) * 2 > used.size()) rehash(used.empty() ? minCapacity : used.size() * 2);
+
+					auto i(getHome(mKey));
+					for(; used[i]; i = (i + 1) & mask) if(keys[i] == mKey) return values[i];
+
+					keys[i] = mKey;
+					used[i] = 1;
+					++count;
+					return values[i];
+				}
+
+				inline bool erase(const TKey& mKey)
+				{
+					const auto slot(findSlot(mKey));
+					if(slot == null) return false;
+
+					eraseSlot(slot);
+					return true;
+				}
+
+				// Erases every entry for which `mPred(key, value)` returns true, in a single pass over the table
+				template<typename TF> inline void eraseIf(TF mPred)
+				{
+					for(auto i(0u); i < used.size();)
+					{
+						// A shifted entry may take the place of the erased one, so the slot is checked again
+						if(used[i] && mPred(keys[i], values[i])) eraseSlot(i);
+						else ++i;
+					}
+				}
+
+				template<typename TF> inline void forEach(TF mFn)		{ for(auto i(0u); i < used.size(); ++i) if(used[i]) mFn(keys[i], values[i]); }
+				template<typename TF> inline void forEach(TF mFn) const	{ for(auto i(0u); i < used.size(); ++i) if(used[i]) mFn(keys[i], values[i]); }
+
+				inline void reserve(SizeT mCount)
+				{
+					auto capacity(minCapacity);
+					while(capacity < mCount * 2) capacity *= 2;
+					if(capacity > used.size()) rehash(capacity);
+				}
+				inline void clear() noexcept { keys.clear(); values.clear(); used.clear(); count = mask = 0; }
+
+				inline SizeT size() const noexcept		{ return count; }
+				inline bool empty() const noexcept		{ return count == 0; }
+				inline SizeT getCapacity() const noexcept	{ return used.size(); }
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,75 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_UTILS_ISLANDS
+#define SSVSC_UTILS_ISLANDS
+
+namespace ssvsc
+{
+	namespace Impl
+	{
+		// Union-find over `[0, nodeCount)`, used to split the bodies of a frame into independent contact islands
+		class Islands
+		{
+			private:
+				static constexpr SizeT null{ssvu::NumLimits<SizeT>::max()};
+
+				std::vector<SizeT> parents, islandOf, offsets, members;
+
+			public:
+				inline void reset(SizeT mNodeCount)
+				{
+					parents.resize(mNodeCount);
+					for(auto i(0u); i < mNodeCount; ++i) parents[i] = i;
+					islandOf.assign(mNodeCount, SizeT(null));
+				}
+
+				inline SizeT find(SizeT mNode) noexcept
+				{
+					while(parents[mNode] != mNode) mNode = parents[mNode] = parents[parents[mNode]];
+					return mNode;
+				}
+
+				inline void join(SizeT mA, SizeT mB) noexcept
+				{
+					mA = find(mA); mB = find(mB);
+					if(mA == mB) return;
+
+					// Always keep the smallest index as root, so the result does not depend on the joining order
+					if(mA < mB) parents[mB] = mA; else parents[mA] = mB;
+				}
+
+				// Groups `mNodes` by island: islands are numbered in order of their first node, and each island lists
+				// the positions (in `mNodes`) of its nodes in their original relative order
+				inline void build(const std::vector<SizeT>& mNodes)
+				{
+					offsets.clear();
+					for(const auto& n : mNodes)
+					{
+						auto& island(islandOf[find(n)]);
+						if(island == null) { island = offsets.size(); offsets.emplace_back(0); }
+						++offsets[island];
+					}
+
+					SizeT sum{0};
+					for(auto& o : offsets) { const auto count(o); o = sum; sum += count; }
+					offsets.emplace_back(sum);
+
+					members.resize(mNodes.size());
+					SizeT i{0};
+					for(const auto& n : mNodes) members[offsets[islandOf[find(n)]]++] = i++;
+
+					// Filling shifted every offset to the start of the next island
+					for(auto j(offsets.size() - 1); j > 0; --j) offsets[j] = offsets[j - 1];
+					offsets[0] = 0;
+				}
+
+				inline SizeT getCount() const noexcept { return offsets.empty() ? 0 : offsets.size() - 1; }
+				inline const SizeT* begin(SizeT mIsland) const noexcept	{ return members.data() + offsets[mIsland]; }
+				inline const SizeT* end(SizeT mIsland) const noexcept	{ return members.data() + offsets[mIsland + 1]; }
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,86 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_UTILS_MAPPEDFILE
+#define SSVSC_UTILS_MAPPEDFILE
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define SSVSC_MAPPED_FILE_MMAP
+#else
+	#include <fstream>
+#endif
+
+namespace ssvsc
+{
+	// Read-only view of a whole file; throws `std::runtime_error` if it cannot be opened
+	// On POSIX systems the file is memory-mapped (shared), so processes mapping the same file share its physical pages and only the pages
+	// actually read are loaded; elsewhere it is read into a buffer. Either way, the data is aligned to at least 64 bytes
+	class MappedFile
+	{
+		private:
+			const char* data{nullptr};
+			SizeT size{0};
+
+			#if defined(SSVSC_MAPPED_FILE_MMAP)
+				void* mapping{nullptr};
+			#else
+				// `std::vector` does not honour over-alignment before C++17: the buffer is over-allocated and the data starts at its first aligned byte
+				static constexpr SizeT alignment{64};
+				std::vector<char> buffer;
+			#endif
+
+		public:
+			inline MappedFile(const std::string& mPath)
+			{
+				#if defined(SSVSC_MAPPED_FILE_MMAP)
+					const int fd{::open(mPath.c_str(), O_RDONLY)};
+					if(fd < 0) throw std::runtime_error{"ssvsc::MappedFile: cannot open " + mPath};
+
+					struct stat info;
+					if(::fstat(fd, &info) != 0) { ::close(fd); throw std::runtime_error{"ssvsc::MappedFile: cannot stat " + mPath}; }
+
+					size = static_cast<SizeT>(info.st_size);
+					if(size > 0)
+					{
+						mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+						if(mapping == MAP_FAILED) { ::close(fd); throw std::runtime_error{"ssvsc::MappedFile: cannot map " + mPath}; }
+						data = static_cast<const char*>(mapping);
+					}
+
+					// The mapping keeps the file alive on its own
+					::close(fd);
+				#else
+					std::ifstream file{mPath, std::ios::binary | std::ios::ate};
+					if(!file) throw std::runtime_error{"ssvsc::MappedFile: cannot open " + mPath};
+
+					size = static_cast<SizeT>(file.tellg());
+					buffer.resize(size + alignment);
+					const auto address(reinterpret_cast<std::uintptr_t>(buffer.data()));
+					char* const aligned{buffer.data() + ((address + alignment - 1) / alignment * alignment - address)};
+
+					file.seekg(0);
+					if(!file.read(aligned, size)) throw std::runtime_error{"ssvsc::MappedFile: cannot read " + mPath};
+					data = aligned;
+				#endif
+			}
+			inline ~MappedFile() noexcept
+			{
+				#if defined(SSVSC_MAPPED_FILE_MMAP)
+					if(mapping != nullptr) ::munmap(mapping, size);
+				#endif
+			}
+
+			inline MappedFile(const MappedFile&) = delete;
+			inline MappedFile& operator=(const MappedFile&) = delete;
+
+			inline const char* getData() const noexcept	{ return data; }
+			inline SizeT getSize() const noexcept		{ return size; }
+	};
+}
+
+#endif
@@ -0,0 +1,146 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_UTILS_OVERLAPKERNEL
+#define SSVSC_UTILS_OVERLAPKERNEL
+
+// Define `SSVSC_DISABLE_SIMD` to always use the scalar kernel
+#if !defined(SSVSC_DISABLE_SIMD) && defined(__AVX2__)
+	#include <immintrin.h>
+	#define SSVSC_OVERLAP_KERNEL_AVX2
+#elif !defined(SSVSC_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#include <emmintrin.h>
+	#define SSVSC_OVERLAP_KERNEL_SSE2
+#endif
+
+namespace ssvsc
+{
+	namespace Impl
+	{
+		constexpr SizeT overlapBatchSize{8};
+
+		// Edges of a batch of `overlapBatchSize` boxes, stored as separate arrays so that a whole batch can be tested at once
+		// Batches live in `std::vector`s, which do not honour over-alignment before C++17: they are only naturally aligned, and loaded with unaligned loads
+		struct OverlapBatch
+		{
+			std::int32_t lefts[overlapBatchSize], rights[overlapBatchSize], tops[overlapBatchSize], bottoms[overlapBatchSize];
+
+			inline void set(SizeT mIdx, const AABB& mShape) noexcept
+			{
+				lefts[mIdx] = mShape.getLeft();
+				rights[mIdx] = mShape.getRight();
+				tops[mIdx] = mShape.getTop();
+				bottoms[mIdx] = mShape.getBottom();
+			}
+			inline void copy(SizeT mIdx, const OverlapBatch& mBatch, SizeT mBatchIdx) noexcept
+			{
+				lefts[mIdx] = mBatch.lefts[mBatchIdx];
+				rights[mIdx] = mBatch.rights[mBatchIdx];
+				tops[mIdx] = mBatch.tops[mBatchIdx];
+				bottoms[mIdx] = mBatch.bottoms[mBatchIdx];
+			}
+		};
+
+		// Returns a bitmask of the boxes among the first `mCount` of `mBatch` overlapping `mShape` (with the same strict test as `AABB::isOverlapping`)
+		inline std::uint32_t getOverlapMask(const AABB& mShape, const OverlapBatch& mBatch, SizeT mCount) noexcept
+		{
+			SSVU_ASSERT(mCount <= overlapBatchSize);
+			const std::uint32_t countMask{(1u << mCount) - 1};
+
+			#if defined(SSVSC_OVERLAP_KERNEL_AVX2)
+				const auto left(_mm256_set1_epi32(mShape.getLeft())), right(_mm256_set1_epi32(mShape.getRight()));
+				const auto top(_mm256_set1_epi32(mShape.getTop())), bottom(_mm256_set1_epi32(mShape.getBottom()));
+
+				const auto x(_mm256_and_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(mBatch.rights)), left),
+					_mm256_cmpgt_epi32(right, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mBatch.lefts)))));
+				const auto y(_mm256_and_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(mBatch.bottoms)), top),
+					_mm256_cmpgt_epi32(bottom, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mBatch.tops)))));
+
+				return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(x, y)))) & countMask;
+			#elif defined(SSVSC_OVERLAP_KERNEL_SSE2)
+				const auto left(_mm_set1_epi32(mShape.getLeft())), right(_mm_set1_epi32(mShape.getRight()));
+				const auto top(_mm_set1_epi32(mShape.getTop())), bottom(_mm_set1_epi32(mShape.getBottom()));
+
+				auto getHalf([&](SizeT mOffset)
+				{
+					const auto x(_mm_and_si128(_mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mBatch.rights + mOffset)), left),
+						_mm_cmpgt_epi32(right, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mBatch.lefts + mOffset)))));
+					const auto y(_mm_and_si128(_mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mBatch.bottoms + mOffset)), top),
+						_mm_cmpgt_epi32(bottom, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mBatch.tops + mOffset)))));
+					return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(x, y))));
+				});
+
+				return (getHalf(0) | getHalf(4) << 4) & countMask;
+			#else
+				const int left{mShape.getLeft()}, right{mShape.getRight()}, top{mShape.getTop()}, bottom{mShape.getBottom()};
+				std::uint32_t result{0};
+
+				for(auto i(0u); i < mCount; ++i)
+					if(mBatch.rights[i] > left && mBatch.lefts[i] < right && mBatch.bottoms[i] > top && mBatch.tops[i] < bottom) result |= 1u << i;
+
+				return result;
+			#endif
+		}
+
+		inline std::uint32_t toGroupBits(const GroupBitset& mGroups) noexcept { return static_cast<std::uint32_t>(mGroups.to_ulong()); }
+
+		// Group masks of a batch of `overlapBatchSize` bodies (or sensors), laid out like `OverlapBatch`
+		struct GroupBatch
+		{
+			std::uint32_t groups[overlapBatchSize], groupsToCheck[overlapBatchSize];
+
+			inline void set(SizeT mIdx, const GroupBitset& mGroups, const GroupBitset& mGroupsToCheck) noexcept
+			{
+				groups[mIdx] = toGroupBits(mGroups);
+				groupsToCheck[mIdx] = toGroupBits(mGroupsToCheck);
+			}
+			inline void copy(SizeT mIdx, const GroupBatch& mBatch, SizeT mBatchIdx) noexcept
+			{
+				groups[mIdx] = mBatch.groups[mBatchIdx];
+				groupsToCheck[mIdx] = mBatch.groupsToCheck[mBatchIdx];
+			}
+		};
+
+		// Returns a bitmask of the entries among the first `mCount` of `mBatch` that belong to any of `mGroupsToCheck` or check any of `mGroups`
+		inline std::uint32_t getGroupMask(const GroupBatch& mBatch, std::uint32_t mGroupsToCheck, std::uint32_t mGroups, SizeT mCount) noexcept
+		{
+			SSVU_ASSERT(mCount <= overlapBatchSize);
+			const std::uint32_t countMask{(1u << mCount) - 1};
+
+			#if defined(SSVSC_OVERLAP_KERNEL_AVX2)
+				const auto hits(_mm256_or_si256(
+					_mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(mBatch.groups)), _mm256_set1_epi32(static_cast<int>(mGroupsToCheck))),
+					_mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(mBatch.groupsToCheck)), _mm256_set1_epi32(static_cast<int>(mGroups)))));
+
+				return ~static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(hits, _mm256_setzero_si256())))) & countMask;
+			#elif defined(SSVSC_OVERLAP_KERNEL_SSE2)
+				const auto groupsToCheck(_mm_set1_epi32(static_cast<int>(mGroupsToCheck))), groups(_mm_set1_epi32(static_cast<int>(mGroups)));
+
+				auto getHalf([&](SizeT mOffset)
+				{
+					const auto hits(_mm_or_si128(_mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mBatch.groups + mOffset)), groupsToCheck),
+						_mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mBatch.groupsToCheck + mOffset)), groups)));
+					return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(hits, _mm_setzero_si128()))));
+				});
+
+				return ~(getHalf(0) | getHalf(4) << 4) & countMask;
+			#else
+				std::uint32_t result{0};
+
+				for(auto i(0u); i < mCount; ++i)
+					if((mBatch.groups[i] & mGroupsToCheck) != 0 || (mBatch.groupsToCheck[i] & mGroups) != 0) result |= 1u << i;
+
+				return result;
+			#endif
+		}
+
+		// Calls `mFn(idx)` for every set bit of `mMask`, from the lowest
+		template<typename TF> inline void forEachBit(std::uint32_t mMask, TF mFn)
+		{
+			for(std::uint32_t i{0}; mMask != 0; ++i, mMask >>= 1) if(mMask & 1u) mFn(i);
+		}
+	}
+}
+
+#endif
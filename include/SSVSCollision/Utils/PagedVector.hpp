@@ -0,0 +1,49 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_UTILS_PAGEDVECTOR
+#define SSVSC_UTILS_PAGEDVECTOR
+
+namespace ssvsc
+{
+	namespace Impl
+	{
+		// Contiguous storage split in fixed-size pages: elements are streamed linearly within a page,
+		// and growing never moves existing elements, so references returned by `operator[]` stay valid
+		template<typename T, SizeT TPageSize = 1024> class PagedVector
+		{
+			private:
+				std::vector<std::vector<T>> pages;
+				SizeT count{0};
+
+				inline auto& getPage(SizeT mIdx) noexcept				{ return pages[mIdx / TPageSize]; }
+				inline const auto& getPage(SizeT mIdx) const noexcept	{ return pages[mIdx / TPageSize]; }
+
+			public:
+				template<typename... TArgs> inline T& emplace_back(TArgs&&... mArgs)
+				{
+					if(count == pages.size() * TPageSize) { pages.emplace_back(); pages.back().reserve(TPageSize); }
+					auto& page(getPage(count++));
+					page.emplace_back(FWD(mArgs)...);
+					return page.back();
+				}
+				inline void pop_back() noexcept
+				{
+					SSVU_ASSERT(count > 0);
+					getPage(--count).pop_back();
+				}
+				inline void clear() noexcept { pages.clear(); count = 0; }
+
+				inline T& operator[](SizeT mIdx) noexcept				{ SSVU_ASSERT(mIdx < count); return getPage(mIdx)[mIdx % TPageSize]; }
+				inline const T& operator[](SizeT mIdx) const noexcept	{ SSVU_ASSERT(mIdx < count); return getPage(mIdx)[mIdx % TPageSize]; }
+				inline T& back() noexcept								{ return (*this)[count - 1]; }
+				inline const T& back() const noexcept					{ return (*this)[count - 1]; }
+
+				inline SizeT size() const noexcept	{ return count; }
+				inline bool empty() const noexcept	{ return count == 0; }
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,148 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_UTILS_STATS
+#define SSVSC_UTILS_STATS
+
+namespace ssvsc
+{
+	enum class StatsPhase : SizeT{Refresh, Integrate, SpatialUpdate, Detection, Resolution, Sensors, PostUpdate, Count};
+
+	// Timings (in microseconds) and counters of the last `World::update`
+	// Only filled when `SSVSC_ENABLE_STATS` is defined before including SSVSCollision: otherwise instrumentation compiles to nothing and stats stay zeroed
+	struct Stats
+	{
+		SizeT frame{0};
+		double frameTime{0};
+		std::array<double, static_cast<SizeT>(StatsPhase::Count)> phaseTimes{};
+
+		SizeT cellsVisited{0};		// Grid cells iterated while looking for collisions
+		SizeT candidatePairs{0};	// Pairs handed to narrowphase by the spatial structure (grids only hand over entries whose stored boxes and group masks pass)
+		SizeT overlaps{0};			// Candidate pairs actually overlapping (and passing group checks)
+		SizeT resolutions{0};		// Bodies passed to the resolver (a pair resolved by both of its bodies counts twice)
+		SizeT rebins{0};			// Bodies or sensors whose grid cells changed
+		SizeT outOfBounds{0};		// Bodies that left the spatial structure
+
+		inline double getTime(StatsPhase mPhase) const noexcept { return phaseTimes[static_cast<SizeT>(mPhase)]; }
+	};
+
+	inline const char* getStatsPhaseName(StatsPhase mPhase) noexcept
+	{
+		static constexpr const char* names[]{"refresh", "integrate", "spatialUpdate", "detection", "resolution", "sensors", "postUpdate"};
+		return names[static_cast<SizeT>(mPhase)];
+	}
+
+	namespace Impl
+	{
+		using StatsClock = std::chrono::steady_clock;
+
+		// Collects the stats of the frame being updated, and optionally keeps a Chrome trace event for every phase scope run by the world
+		class StatsRecorder
+		{
+			private:
+				struct Event { const char* name; double start, duration; SizeT frame; };
+
+				Stats current, last;
+				std::vector<Event> events;
+				StatsClock::time_point origin{StatsClock::now()}, frameStart;
+				bool tracing{false};
+
+				inline double getTimeSinceOrigin(StatsClock::time_point mTime) const noexcept { return std::chrono::duration<double, std::micro>(mTime - origin).count(); }
+
+			public:
+				inline void beginFrame(SizeT mFrame) noexcept
+				{
+					current = Stats{};
+					current.frame = mFrame;
+					frameStart = StatsClock::now();
+				}
+				inline void endFrame()
+				{
+					const auto now(StatsClock::now());
+					current.frameTime = std::chrono::duration<double, std::micro>(now - frameStart).count();
+					if(tracing) events.push_back({"update", getTimeSinceOrigin(frameStart), current.frameTime, current.frame});
+					last = current;
+				}
+
+				inline void addTime(StatsPhase mPhase, StatsClock::time_point mStart, StatsClock::time_point mEnd) noexcept
+				{
+					current.phaseTimes[static_cast<SizeT>(mPhase)] += std::chrono::duration<double, std::micro>(mEnd - mStart).count();
+				}
+				inline void addEvent(const char* mName, StatsClock::time_point mStart, StatsClock::time_point mEnd)
+				{
+					if(tracing) events.push_back({mName, getTimeSinceOrigin(mStart), std::chrono::duration<double, std::micro>(mEnd - mStart).count(), current.frame});
+				}
+
+				inline void setTracing(bool mTracing) noexcept { tracing = mTracing; }
+				inline void clearTrace() noexcept { events.clear(); }
+
+				// Writes the recorded events in the Chrome trace event format (load it in chrome://tracing or Perfetto)
+				// Times are in microseconds, written in fixed notation down to the nanosecond: default formatting keeps 6 significant digits,
+				// which drops below microsecond resolution one second into the trace; the stream's formatting is restored afterwards
+				inline void writeTrace(std::ostream& mStream) const
+				{
+					const auto flags(mStream.flags());
+					const auto precision(mStream.precision());
+					mStream.setf(std::ios::fixed, std::ios::floatfield);
+					mStream.precision(3);
+
+					mStream << "{\"traceEvents\":[";
+					for(auto i(0u); i < events.size(); ++i)
+					{
+						const auto& e(events[i]);
+						mStream << (i == 0 ? "" : ",") << "\n{\"name\":\"" << e.name << "\",\"cat\":\"ssvsc\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":"
+							<< e.start << ",\"dur\":" << e.duration << ",\"args\":{\"frame\":" << e.frame << "}}";
+					}
+					mStream << "\n]}\n";
+
+					mStream.flags(flags);
+					mStream.precision(precision);
+				}
+
+				inline Stats& getCurrent() noexcept				{ return current; }
+				inline const Stats& getLast() const noexcept	{ return last; }
+				inline bool isTracing() const noexcept			{ return tracing; }
+		};
+
+		// Adds the time spent in its scope to `phase` (if any), and records it as a trace event named `name` (if any)
+		class StatsScope
+		{
+			private:
+				StatsRecorder& recorder;
+				StatsPhase phase;
+				const char* name;
+				StatsClock::time_point start{StatsClock::now()};
+
+			public:
+				inline StatsScope(StatsRecorder& mRecorder, StatsPhase mPhase, const char* mName) noexcept : recorder(mRecorder), phase{mPhase}, name{mName} { }
+				inline ~StatsScope()
+				{
+					const auto end(StatsClock::now());
+					if(phase != StatsPhase::Count) recorder.addTime(phase, start, end);
+					if(name != nullptr) recorder.addEvent(name, start, end);
+				}
+		};
+	}
+}
+
+#define SSVSC_STATS_CAT_IMPL(mA, mB) mA ## mB
+#define SSVSC_STATS_CAT(mA, mB) SSVSC_STATS_CAT_IMPL(mA, mB)
+
+#ifdef SSVSC_ENABLE_STATS
+	#define SSVSC_STATS_COUNT(mWorld, mCounter, mAmount) ((mWorld).stats.getCurrent().mCounter += (mAmount))
+	#define SSVSC_STATS_TIME(mWorld, mPhase) ::ssvsc::Impl::StatsScope SSVSC_STATS_CAT(ssvscStatsScope, __LINE__){(mWorld).stats, mPhase, nullptr}
+	#define SSVSC_STATS_TRACE(mWorld, mPhase) ::ssvsc::Impl::StatsScope SSVSC_STATS_CAT(ssvscStatsScope, __LINE__){(mWorld).stats, mPhase, ::ssvsc::getStatsPhaseName(mPhase)}
+	#define SSVSC_STATS_EVENT(mWorld, mName) ::ssvsc::Impl::StatsScope SSVSC_STATS_CAT(ssvscStatsScope, __LINE__){(mWorld).stats, ::ssvsc::StatsPhase::Count, mName}
+	#define SSVSC_STATS_BEGIN_FRAME(mWorld) (mWorld).stats.beginFrame((mWorld).frame)
+	#define SSVSC_STATS_END_FRAME(mWorld) (mWorld).stats.endFrame()
+#else
+	#define SSVSC_STATS_COUNT(mWorld, mCounter, mAmount) ((void)0)
+	#define SSVSC_STATS_TIME(mWorld, mPhase) ((void)0)
+	#define SSVSC_STATS_TRACE(mWorld, mPhase) ((void)0)
+	#define SSVSC_STATS_EVENT(mWorld, mName) ((void)0)
+	#define SSVSC_STATS_BEGIN_FRAME(mWorld) ((void)0)
+	#define SSVSC_STATS_END_FRAME(mWorld) ((void)0)
+#endif
+
+#endif
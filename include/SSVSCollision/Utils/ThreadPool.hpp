@@ -0,0 +1,136 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_UTILS_THREADPOOL
+#define SSVSC_UTILS_THREADPOOL
+
+namespace ssvsc
+{
+	namespace Impl
+	{
+		// Fork-join pool running `fn(idx)` for every `idx` in `[0, count)`
+		// Every worker (the calling thread included) starts on its own contiguous range of indices, then steals from the ranges of the others once it runs dry
+		// Jobs must not throw
+		class ThreadPool
+		{
+			private:
+				struct Range { std::atomic<SizeT> next{0}; SizeT end{0}; };
+
+				std::vector<std::thread> threads;
+				UPtr<Range[]> ranges;
+				SizeT workerCount;
+
+				std::mutex mtx;
+				std::condition_variable cvStart, cvDone;
+				SizeT generation{0}, pending{0};
+				bool stopping{false};
+
+				void* jobCtx{nullptr};
+				void(*jobFn)(void*, SizeT){nullptr};
+
+				inline static SizeT& getCurrentWorkerImpl() noexcept { thread_local SizeT worker{0}; return worker; }
+
+				inline bool tryRun(SizeT mWorker) noexcept
+				{
+					auto& r(ranges[mWorker]);
+					const auto idx(r.next.fetch_add(1, std::memory_order_relaxed));
+					if(idx >= r.end) return false;
+
+					jobFn(jobCtx, idx);
+					return true;
+				}
+
+				inline void work(SizeT mWorker) noexcept
+				{
+					while(tryRun(mWorker)) { }
+					for(auto i(1u); i < workerCount; ++i)
+					{
+						const auto victim((mWorker + i) % workerCount);
+						while(tryRun(victim)) { }
+					}
+				}
+
+				inline void loop(SizeT mWorker)
+				{
+					SizeT lastGeneration{0};
+					getCurrentWorkerImpl() = mWorker;
+
+					while(true)
+					{
+						{
+							std::unique_lock<std::mutex> lock{mtx};
+							cvStart.wait(lock, [this, &lastGeneration]{ return stopping || generation != lastGeneration; });
+							if(stopping) return;
+							lastGeneration = generation;
+						}
+
+						work(mWorker);
+
+						std::lock_guard<std::mutex> lock{mtx};
+						if(--pending == 0) cvDone.notify_one();
+					}
+				}
+
+			public:
+				inline ThreadPool(SizeT mWorkerCount) : ranges{new Range[mWorkerCount]}, workerCount{mWorkerCount}
+				{
+					SSVU_ASSERT(mWorkerCount > 0);
+					for(auto i(1u); i < workerCount; ++i) threads.emplace_back([this, i]{ loop(i); });
+				}
+				inline ~ThreadPool()
+				{
+					{
+						std::lock_guard<std::mutex> lock{mtx};
+						stopping = true;
+					}
+					cvStart.notify_all();
+					for(auto& t : threads) t.join();
+				}
+
+				inline ThreadPool(const ThreadPool&) = delete;
+				inline ThreadPool& operator=(const ThreadPool&) = delete;
+
+				template<typename TF> inline void run(SizeT mCount, TF& mFn)
+				{
+					if(mCount == 0) return;
+
+					jobCtx = &mFn;
+					jobFn = [](void* mCtx, SizeT mIdx){ (*static_cast<TF*>(mCtx))(mIdx); };
+
+					const auto chunk(mCount / workerCount), extra(mCount % workerCount);
+					SizeT begin{0};
+					for(auto i(0u); i < workerCount; ++i)
+					{
+						const auto end(begin + chunk + (i < extra ? 1 : 0));
+						ranges[i].next.store(begin, std::memory_order_relaxed);
+						ranges[i].end = end;
+						begin = end;
+					}
+
+					{
+						std::lock_guard<std::mutex> lock{mtx};
+						pending = workerCount - 1;
+						++generation;
+					}
+					cvStart.notify_all();
+
+					// The calling thread may itself be a worker of another pool
+					const auto callerWorker(getCurrentWorkerImpl());
+					getCurrentWorkerImpl() = 0;
+					work(0);
+					getCurrentWorkerImpl() = callerWorker;
+
+					std::unique_lock<std::mutex> lock{mtx};
+					cvDone.wait(lock, [this]{ return pending == 0; });
+				}
+
+				inline SizeT getWorkerCount() const noexcept { return workerCount; }
+
+				// Index of the worker running the current job, in `[0, getWorkerCount())`; only meaningful from inside a job
+				inline static SizeT getCurrentWorker() noexcept { return getCurrentWorkerImpl(); }
+		};
+	}
+}
+
+#endif
@@ -22,6 +22,39 @@ namespace ssvsc
 		inline int getOverlapX(const AABB& mA, const AABB& mB) noexcept			{ return mA.getLeft() < mB.getLeft() ? mA.getRight() - mB.getLeft() : mB.getRight() - mA.getLeft(); }
 		inline int getOverlapY(const AABB& mA, const AABB& mB) noexcept			{ return mA.getTop() < mB.getTop() ? mA.getBottom() - mB.getTop() : mB.getBottom() - mA.getTop(); }
 		inline int getOverlapArea(const AABB& mA, const AABB& mB) noexcept		{ return getOverlapX(mA, mB) * getOverlapY(mA, mB); }
+
+		// Time of impact of `mA` moving by `mDelta` against the still `mB`, as a fraction of the move in [0, 1]; `mAxisX` tells whether the contact is on the X axis
+		// Returns false if they never overlap during the move, or already overlap at its start
+		inline bool getSweptEntry(const AABB& mA, const Vec2i& mDelta, const AABB& mB, float& mT, bool& mAxisX) noexcept
+		{
+			if(mA.isOverlapping(mB)) return false;
+
+			const int aMins[2]{mA.getLeft(), mA.getTop()}, aMaxs[2]{mA.getRight(), mA.getBottom()};
+			const int bMins[2]{mB.getLeft(), mB.getTop()}, bMaxs[2]{mB.getRight(), mB.getBottom()};
+			const int deltas[2]{mDelta.x, mDelta.y};
+			float entries[2], exits[2];
+
+			for(int a{0}; a < 2; ++a)
+			{
+				const auto d(static_cast<float>(deltas[a]));
+
+				if(deltas[a] == 0)
+				{
+					if(aMaxs[a] <= bMins[a] || aMins[a] >= bMaxs[a]) return false;
+					entries[a] = -ssvu::NumLimits<float>::max();
+					exits[a] = ssvu::NumLimits<float>::max();
+				}
+				else if(deltas[a] > 0)	{ entries[a] = (bMins[a] - aMaxs[a]) / d; exits[a] = (bMaxs[a] - aMins[a]) / d; }
+				else					{ entries[a] = (bMaxs[a] - aMins[a]) / d; exits[a] = (bMins[a] - aMaxs[a]) / d; }
+			}
+
+			const auto entry(std::max(entries[0], entries[1])), exit(std::min(exits[0], exits[1]));
+			if(entry >= exit || entry < 0 || entry > 1) return false;
+
+			mT = entry;
+			mAxisX = entries[0] > entries[1];
+			return true;
+		}
 	}
 }
 
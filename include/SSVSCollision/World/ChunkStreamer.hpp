@@ -0,0 +1,125 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_WORLD_CHUNKSTREAMER
+#define SSVSC_WORLD_CHUNKSTREAMER
+
+namespace ssvsc
+{
+	template<typename TW> class Body;
+
+	// Keeps the bodies of a world using a `ChunkedGrid` loaded only around points of interest, for maps too large to simulate at once
+	// Chunks are the pages of the grid, and a body belongs to the chunk containing the center of its shape; distances are in chunks, along the larger axis
+	// Every `update` evicts the chunks farther than `unloadRadius` from all points of interest: their bodies are frozen (see `World::freeze`) into
+	// blobs kept by the streamer, and the pages nothing occupies anymore are released; frozen chunks within `loadRadius` of a point of interest are thawed
+	// Bodies entering a frozen chunk do not collide with its frozen bodies until it is thawed; sensors are never frozen
+	template<typename TW> class ChunkStreamer
+	{
+		public:
+			using BodyType = Body<TW>;
+
+		private:
+			TW& world;
+			int loadRadius, unloadRadius;
+			Impl::FlatHashMap<std::uint64_t, std::vector<std::vector<char>>> frozen;
+			Impl::FlatHashMap<std::uint64_t, SizeT> evictions;
+			std::vector<std::vector<BodyType*>> evicted;
+			std::vector<Vec2i> evictedChunks, pointChunks;
+			static constexpr SizeT null{ssvu::NumLimits<SizeT>::max()};
+
+			inline static std::uint64_t getKey(const Vec2i& mChunk) noexcept { return Impl::getGridKey(mChunk.x, mChunk.y); }
+
+			inline int getDistance(const Vec2i& mChunk) const noexcept
+			{
+				auto result(ssvu::NumLimits<int>::max());
+				for(const auto& c : pointChunks) result = std::min(result, std::max(std::abs(mChunk.x - c.x), std::abs(mChunk.y - c.y)));
+				return result;
+			}
+
+		public:
+			inline ChunkStreamer(TW& mWorld, int mLoadRadius, int mUnloadRadius) : world(mWorld), loadRadius{mLoadRadius}, unloadRadius{mUnloadRadius}
+			{
+				SSVU_ASSERT(loadRadius >= 0 && unloadRadius >= loadRadius);
+			}
+
+			inline Vec2i getChunk(const Vec2i& mPos) const noexcept { const auto& grid(world.getSpatial()); return grid.getPageIdx(grid.getIdx(mPos)); }
+
+			// Evicts and activates chunks around `mPoints`; `mOnFreeze(body)` is called on every body before it is frozen, and `mOnThaw(body)` on every
+			// thawed body, once all the bodies of its blob are restored (e.g. to detach and reattach callbacks and user data)
+			// Bodies created since the last world update are only considered by the next call, while destroyed ones (including the ones frozen by
+			// an earlier call) are skipped right away; must not be called while the world is updating
+			template<typename TFreeze, typename TThaw> inline void update(const std::vector<Vec2i>& mPoints, TFreeze mOnFreeze, TThaw mOnThaw)
+			{
+				pointChunks.clear();
+				for(const auto& p : mPoints) pointChunks.emplace_back(getChunk(p));
+
+				// Evicted bodies are bucketed by chunk in a single pass, deciding once per chunk
+				evictions.clear();
+				evictedChunks.clear();
+				for(auto& e : evicted) e.clear();
+
+				for(const auto& b : world.getBodies())
+				{
+					if(!b->isAlive() || b->isProxy()) continue;
+
+					const auto chunk(getChunk(b->getPosition()));
+					auto& eviction(evictions[getKey(chunk)]);
+					if(eviction == 0)
+					{
+						// Evictions are stored offset by one, so that zero (the default value) marks a new chunk
+						if(getDistance(chunk) <= unloadRadius) { eviction = null; continue; }
+
+						evictedChunks.emplace_back(chunk);
+						if(evicted.size() < evictedChunks.size()) evicted.emplace_back();
+						eviction = evictedChunks.size();
+					}
+
+					if(eviction != null) evicted[eviction - 1].emplace_back(b.get());
+				}
+
+				for(auto i(0u); i < evictedChunks.size(); ++i)
+				{
+					for(const auto& b : evicted[i]) mOnFreeze(*b);
+
+					std::vector<char> blob;
+					world.freeze(evicted[i], blob);
+					frozen[getKey(evictedChunks[i])].emplace_back(std::move(blob));
+				}
+				if(!evictedChunks.empty()) world.getSpatial().releaseEmptyPages();
+
+				for(const auto& c : pointChunks)
+					for(int iY{c.y - loadRadius}; iY <= c.y + loadRadius; ++iY)
+						for(int iX{c.x - loadRadius}; iX <= c.x + loadRadius; ++iX)
+						{
+							const auto key(getKey({iX, iY}));
+							auto* blobs(frozen.find(key));
+							if(blobs == nullptr) continue;
+
+							// Values of the map move around on erasure
+							const auto thawed(std::move(*blobs));
+							frozen.erase(key);
+							for(const auto& blob : thawed) world.thaw(blob.data(), blob.size(), mOnThaw);
+						}
+			}
+			inline void update(const std::vector<Vec2i>& mPoints) { update(mPoints, [](BodyType&){ }, [](BodyType&){ }); }
+
+			// Frozen blobs can be moved out of memory (e.g. written to disk with `forEachFrozen`, then erased) and handed back with `addFrozen`,
+			// also usable to seed chunks with bodies authored offline; they are thawed as soon as their chunk is within `loadRadius` of a point of interest
+			inline void addFrozen(const Vec2i& mChunk, std::vector<char> mBlob)	{ frozen[getKey(mChunk)].emplace_back(std::move(mBlob)); }
+			inline void eraseFrozen(const Vec2i& mChunk)						{ frozen.erase(getKey(mChunk)); }
+			inline bool isFrozen(const Vec2i& mChunk) const noexcept			{ return frozen.find(getKey(mChunk)) != nullptr; }
+
+			// Calls `mFn(chunk, blob)` for every frozen blob
+			template<typename TF> inline void forEachFrozen(TF mFn) const
+			{
+				frozen.forEach([&mFn](std::uint64_t mKey, const std::vector<std::vector<char>>& mBlobs){ for(const auto& b : mBlobs) mFn(Impl::getGridKeyIdx(mKey), b); });
+			}
+
+			inline SizeT getFrozenChunkCount() const noexcept	{ return frozen.size(); }
+			inline int getLoadRadius() const noexcept			{ return loadRadius; }
+			inline int getUnloadRadius() const noexcept			{ return unloadRadius; }
+	};
+}
+
+#endif
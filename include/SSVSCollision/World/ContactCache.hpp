@@ -0,0 +1,164 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_WORLD_CONTACTCACHE
+#define SSVSC_WORLD_CONTACTCACHE
+
+namespace ssvsc
+{
+	template<typename TW> class Body;
+
+	namespace Impl
+	{
+		// Persistent set of the overlapping body pairs, turning per-frame detections into begin/stay/end contact events; only used with `ContactSettings::enabled`
+		// Pairs are keyed by their body handles (lower one first); since handles are reused, the generation of both handles is stored too,
+		// so that a pair involving a destroyed body is never mistaken for a pair involving the body that took its handle
+		template<typename TW> class ContactCache
+		{
+			private:
+				using BodyType = Body<TW>;
+				struct Contact { BodyType* a; BodyType* b; std::uint32_t generationA, generationB; SizeT frame; };
+
+				FlatHashMap<std::uint64_t, Contact> contacts;
+
+				inline static std::uint64_t getKey(BodyHandle mA, BodyHandle mB) noexcept
+				{
+					SSVU_ASSERT(mA < mB && mB <= 0xFFFFFFFFu);
+					return std::uint64_t(mA) << 32 | std::uint64_t(mB);
+				}
+
+				// Bodies of a contact are only dereferenced after checking that their handle still has the generation stored in the contact
+				template<typename TStore> inline static void end(const TStore& mStore, std::uint64_t mKey, const Contact& mContact)
+				{
+					const bool aliveA{mStore.getGeneration(mKey >> 32) == mContact.generationA};
+					const bool aliveB{mStore.getGeneration(mKey & 0xFFFFFFFFu) == mContact.generationB};
+
+					if(aliveA) mContact.a->dispatchContact(EventType::ContactEnd, aliveB ? mContact.b : nullptr);
+					if(aliveB) mContact.b->dispatchContact(EventType::ContactEnd, aliveA ? mContact.a : nullptr);
+				}
+
+			public:
+				// Records that `mA` and `mB` overlap during `mFrame`, returning whether their contact begins with it
+				// Must be called at most once per pair and frame, and never concurrently
+				template<typename TStore> inline bool touch(const TStore& mStore, BodyType& mA, BodyType& mB, SizeT mFrame)
+				{
+					auto& first(mA.getHandle() < mB.getHandle() ? mA : mB);
+					auto& second(&first == &mA ? mB : mA);
+					const auto key(getKey(first.getHandle(), second.getHandle()));
+					const auto generationA(mStore.getGeneration(first.getHandle())), generationB(mStore.getGeneration(second.getHandle()));
+
+					auto& contact(contacts[key]);
+					const bool stays{contact.a != nullptr && contact.generationA == generationA && contact.generationB == generationB};
+					const auto old(contact);
+					contact = {&first, &second, generationA, generationB, mFrame};
+					if(stays) return false;
+
+					// The handles were reused: the contact of their previous owners ends first
+					if(old.a != nullptr) end(mStore, key, old);
+					return true;
+				}
+
+				// Ends every contact not touched during `mFrame` whose bodies could have detected it, that is unless both bodies were alive and
+				// not stepped (static, asleep or out of bounds): a sleeping body keeps its contacts until it wakes
+				template<typename TStore> inline void endStale(const TStore& mStore, SizeT mFrame)
+				{
+					contacts.eraseIf([&mStore, mFrame](std::uint64_t mKey, const Contact& mContact)
+					{
+						if(mContact.frame == mFrame) return false;
+
+						const bool aliveA{mStore.getGeneration(mKey >> 32) == mContact.generationA};
+						const bool aliveB{mStore.getGeneration(mKey & 0xFFFFFFFFu) == mContact.generationB};
+						if(aliveA && aliveB && mContact.a->stepFrame != mFrame && mContact.b->stepFrame != mFrame) return false;
+
+						end(mStore, mKey, mContact);
+						return true;
+					});
+				}
+
+				// Forgets every contact without firing any event
+				inline void clear() noexcept { contacts.clear(); }
+
+				// Contacts are written sorted by key, so that equal caches always give equal bytes, whatever their insertion history
+				// Proxies of a `StaticLevel` are not part of snapshots: contacts with a live one are written apart, by body and level entry
+				template<typename TStore> inline void write(const TStore& mStore, BlobWriter& mWriter) const
+				{
+					std::vector<std::uint64_t> keys, levelKeys;
+					keys.reserve(contacts.size());
+					contacts.forEach([&mStore, &keys, &levelKeys](std::uint64_t mKey, const Contact& mContact)
+					{
+						const bool proxyA{mStore.getGeneration(mKey >> 32) == mContact.generationA && mContact.a->isProxy()};
+						const bool proxyB{mStore.getGeneration(mKey & 0xFFFFFFFFu) == mContact.generationB && mContact.b->isProxy()};
+						(proxyA || proxyB ? levelKeys : keys).emplace_back(mKey);
+					});
+					ssvu::sort(keys);
+					ssvu::sort(levelKeys);
+
+					mWriter.write(std::uint64_t(keys.size()));
+					for(const auto& k : keys)
+					{
+						const auto& contact(*contacts.find(k));
+						mWriter.write(k);
+						mWriter.write(contact.generationA);
+						mWriter.write(contact.generationB);
+						mWriter.write(std::uint64_t(contact.frame));
+					}
+
+					// Proxies never detect each other, so the other body of a level contact is never a proxy
+					mWriter.write(std::uint64_t(levelKeys.size()));
+					for(const auto& k : levelKeys)
+					{
+						const auto& contact(*contacts.find(k));
+						const bool proxyA{contact.a->isProxy()};
+						mWriter.write(std::uint64_t(proxyA ? k & 0xFFFFFFFFu : k >> 32));
+						mWriter.write(proxyA ? contact.generationB : contact.generationA);
+						mWriter.write((proxyA ? contact.a : contact.b)->levelId);
+						mWriter.write(std::uint64_t(contact.frame));
+					}
+				}
+
+				// Replaces every contact with the ones of `write`, without firing any event; contacts whose bodies were destroyed since keep a null
+				// pointer to them, which is never dereferenced as their generation does not match anymore
+				// Level contacts get their proxy from `mGetLevelProxy(levelId)`, and are dropped if it returns null (no level attached) or if their body is gone
+				template<typename TStore, typename TF> inline void read(const TStore& mStore, BlobReader& mReader, TF mGetLevelProxy)
+				{
+					contacts.clear();
+
+					auto getOwner([&mStore](BodyHandle mHandle, std::uint32_t mGeneration) -> BodyType*
+					{
+						if(!mStore.isAlive(mHandle) || mStore.getGeneration(mHandle) != mGeneration) return nullptr;
+						return mStore.owners[mStore.getIdx(mHandle)];
+					});
+
+					for(auto i(mReader.readCount(sizeof(std::uint64_t) * 2 + sizeof(std::uint32_t) * 2)); i > 0; --i)
+					{
+						const auto key(mReader.read<std::uint64_t>());
+						const auto generationA(mReader.read<std::uint32_t>()), generationB(mReader.read<std::uint32_t>());
+						const auto frame(mReader.read<std::uint64_t>());
+
+						contacts[key] = {getOwner(key >> 32, generationA), getOwner(key & 0xFFFFFFFFu, generationB), generationA, generationB, frame};
+					}
+
+					for(auto i(mReader.readCount(sizeof(std::uint64_t) * 2 + sizeof(std::uint32_t) * 2)); i > 0; --i)
+					{
+						const auto handle(mReader.read<std::uint64_t>());
+						const auto generation(mReader.read<std::uint32_t>()), levelId(mReader.read<std::uint32_t>());
+						const auto frame(mReader.read<std::uint64_t>());
+
+						auto* body(getOwner(handle, generation));
+						if(body == nullptr) continue;
+						auto* proxy(mGetLevelProxy(levelId));
+						if(proxy == nullptr) continue;
+
+						auto& first(body->getHandle() < proxy->getHandle() ? *body : *proxy);
+						auto& second(&first == body ? *proxy : *body);
+						contacts[getKey(first.getHandle(), second.getHandle())] = {&first, &second, mStore.getGeneration(first.getHandle()), mStore.getGeneration(second.getHandle()), frame};
+					}
+				}
+
+				inline SizeT getSize() const noexcept { return contacts.size(); }
+		};
+	}
+}
+
+#endif
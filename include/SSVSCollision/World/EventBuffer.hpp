@@ -0,0 +1,149 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_WORLD_EVENTBUFFER
+#define SSVSC_WORLD_EVENTBUFFER
+
+namespace ssvsc
+{
+	template<typename TW> class Base;
+	template<typename TW> class Body;
+	template<typename TW> class Sensor;
+	template<typename TW> struct ContactInfo;
+
+	// `Inline` calls detection, resolution and contact callbacks as soon as the events happen, in the middle of the step (default)
+	// `Deferred` records the events during the step and dispatches them in one batch at the end of `World::update`, in the order they happened
+	// `DeferredByBody` is like `Deferred`, but groups the events by the body (or sensor) receiving them, in order of their first event
+	// When deferred, resolution callbacks cannot cancel resolutions anymore: `noResolvePosition` and `noResolveVelocity` are ignored
+	enum class EventDispatch{Inline, Deferred, DeferredByBody};
+
+	namespace Impl
+	{
+		enum class EventType : std::uint8_t{Detection, Resolution, ContactBegin, ContactStay, ContactEnd, SensorDetection};
+
+		// Flat structure-of-arrays buffer of the events recorded during a frame, tagged by type
+		// Receivers and other bodies (or sensors) stay valid until dispatch, as destroyed ones are only deleted at the start of the next update
+		template<typename TW> class EventBuffer
+		{
+			private:
+				std::vector<EventType> types;
+				std::vector<Base<TW>*> receivers;
+				std::vector<Base<TW>*> others;
+				std::vector<void*> userDatas;
+				std::vector<Vec2i> resolutions;
+
+				std::vector<std::pair<SizeT, SizeT>> order;
+				FlatHashMap<std::uintptr_t, SizeT> ranks;
+
+				inline void pushFrom(const EventBuffer& mBuffer, SizeT mIdx)
+				{
+					types.emplace_back(mBuffer.types[mIdx]);
+					receivers.emplace_back(mBuffer.receivers[mIdx]);
+					others.emplace_back(mBuffer.others[mIdx]);
+					userDatas.emplace_back(mBuffer.userDatas[mIdx]);
+					resolutions.emplace_back(mBuffer.resolutions[mIdx]);
+				}
+
+				// Stably reorders the events from `mBegin` on by `order` (filled with key/index pairs), using `mScratch` as temporary storage
+				inline void applyOrder(SizeT mBegin, EventBuffer& mScratch)
+				{
+					ssvu::sort(order);
+
+					mScratch.clear();
+					for(auto i(0u); i < mBegin; ++i) mScratch.pushFrom(*this, i);
+					for(const auto& o : order) mScratch.pushFrom(*this, o.second);
+					swap(mScratch);
+				}
+
+				inline void swap(EventBuffer& mBuffer) noexcept
+				{
+					types.swap(mBuffer.types);
+					receivers.swap(mBuffer.receivers);
+					others.swap(mBuffer.others);
+					userDatas.swap(mBuffer.userDatas);
+					resolutions.swap(mBuffer.resolutions);
+				}
+
+			public:
+				inline void push(EventType mType, Base<TW>& mReceiver, Body<TW>* mOther, const Vec2i& mResolution = {})
+				{
+					types.emplace_back(mType);
+					receivers.emplace_back(&mReceiver);
+					others.emplace_back(mOther);
+					userDatas.emplace_back(mOther != nullptr ? mOther->getUserData() : nullptr);
+					resolutions.emplace_back(mResolution);
+				}
+				inline void push(EventType mType, Base<TW>& mReceiver, Sensor<TW>& mOther)
+				{
+					types.emplace_back(mType);
+					receivers.emplace_back(&mReceiver);
+					others.emplace_back(&mOther);
+					userDatas.emplace_back(nullptr);
+					resolutions.emplace_back();
+				}
+
+				// Moves every event of `mBuffer` at the end of this buffer
+				inline void append(EventBuffer& mBuffer)
+				{
+					for(auto i(0u); i < mBuffer.getSize(); ++i) pushFrom(mBuffer, i);
+					mBuffer.clear();
+				}
+
+				// Stably sorts the events from `mBegin` on by `mKey(receiver)`
+				template<typename TF> inline void sortByReceiver(SizeT mBegin, const TF& mKey, EventBuffer& mScratch)
+				{
+					order.clear();
+					for(auto i(mBegin); i < getSize(); ++i) order.emplace_back(mKey(*receivers[i]), i);
+					applyOrder(mBegin, mScratch);
+				}
+
+				// Stably groups the events by receiver, receivers being ordered by their first event
+				inline void groupByReceiver(EventBuffer& mScratch)
+				{
+					ranks.clear();
+					order.clear();
+					for(auto i(0u); i < getSize(); ++i)
+					{
+						auto& rank(ranks[reinterpret_cast<std::uintptr_t>(receivers[i])]);
+						if(rank == 0) rank = ranks.size();
+						order.emplace_back(rank, i);
+					}
+					applyOrder(0, mScratch);
+				}
+
+				// Calls the callbacks of every recorded event, then clears the buffer
+				inline void dispatch(FT mFT)
+				{
+					for(auto i(0u); i < getSize(); ++i)
+					{
+						auto& receiver(*receivers[i]);
+						auto* other(types[i] == EventType::SensorDetection ? nullptr : static_cast<Body<TW>*>(others[i]));
+						const ContactInfo<TW> contactInfo{other, userDatas[i]};
+
+						switch(types[i])
+						{
+							case EventType::Detection: receiver.onDetection({*other, userDatas[i], mFT}); break;
+							case EventType::Resolution:
+							{
+								bool noResolvePosition{false}, noResolveVelocity{false};
+								ssvu::castUp<Body<TW>>(receiver).onResolution({*other, userDatas[i], resolutions[i], noResolvePosition, noResolveVelocity});
+								break;
+							}
+							case EventType::ContactBegin: ssvu::castUp<Body<TW>>(receiver).onContactBegin(contactInfo); break;
+							case EventType::ContactStay: ssvu::castUp<Body<TW>>(receiver).onContactStay(contactInfo); break;
+							case EventType::ContactEnd: ssvu::castUp<Body<TW>>(receiver).onContactEnd(contactInfo); break;
+							case EventType::SensorDetection: ssvu::castUp<Sensor<TW>>(receiver).onSensorDetection({ssvu::castUp<Sensor<TW>>(*others[i]), mFT}); break;
+						}
+					}
+
+					clear();
+				}
+
+				inline void clear() noexcept { types.clear(); receivers.clear(); others.clear(); userDatas.clear(); resolutions.clear(); }
+				inline SizeT getSize() const noexcept { return types.size(); }
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,186 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_WORLD_TILELAYER
+#define SSVSC_WORLD_TILELAYER
+
+namespace ssvsc
+{
+	template<typename TW> class Body;
+
+	struct TileHit
+	{
+		bool hit{false};
+		Vec2i tile, normal;
+		float distance{0};
+		Vec2f point;
+
+		inline explicit operator bool() const noexcept { return hit; }
+	};
+
+	// Collision layer built from an occupancy bitmap of `cols` * `rows` square tiles, the top-left one starting at `origin`
+	// Instead of one static body per tile, `rebuild` greedily merges solid tiles into rectangles (as wide as possible, then as tall as possible)
+	// and creates one static body per rectangle, so that bodies slide along floors without snagging on the seams between tiles
+	// Point and ray queries walk the bitmap directly, and always reflect the last `setSolid` calls; merged bodies only follow them on `rebuild`
+	// Merged bodies belong to the world: `clear` (or `rebuild`) destroys them, while destroying the layer leaves them in the world
+	// They are tracked by handle and generation, so that merged bodies destroyed by the game in the meantime are skipped
+	template<typename TW> class TileLayer
+	{
+		public:
+			using BodyType = Body<TW>;
+
+		private:
+			TW& world;
+			Vec2i origin;
+			int tileSize, cols, rows;
+			std::vector<std::uint8_t> tiles;
+			std::vector<std::pair<BodyHandle, std::uint32_t>> bodies;
+
+			inline SizeT getIdx(int mX, int mY) const noexcept { return ssvu::get1DIdxFrom2D(mX, mY, cols); }
+
+			// Returns the merged body of `mEntry`, or `nullptr` if it was destroyed and freed since
+			inline BodyType* getBody(const std::pair<BodyHandle, std::uint32_t>& mEntry) const noexcept
+			{
+				const auto& store(world.getBodyStore());
+				if(!store.isAlive(mEntry.first) || store.getGeneration(mEntry.first) != mEntry.second) return nullptr;
+				return store.owners[store.getIdx(mEntry.first)];
+			}
+
+		public:
+			// `mTileSize` must be even, as bodies store their half size
+			inline TileLayer(TW& mWorld, const Vec2i& mOrigin, int mTileSize, int mCols, int mRows) : world(mWorld), origin{mOrigin}, tileSize{mTileSize},
+				cols{mCols}, rows{mRows}, tiles(SizeT(mCols * mRows), 0)
+			{
+				SSVU_ASSERT(tileSize > 0 && tileSize % 2 == 0 && cols > 0 && rows > 0);
+			}
+
+			inline void setSolid(int mX, int mY, bool mSolid) noexcept { SSVU_ASSERT(isIdxValid(mX, mY)); tiles[getIdx(mX, mY)] = mSolid; }
+
+			// Sets every tile from `mFn(x, y)`
+			template<typename TF> inline void fill(TF mFn)
+			{
+				for(int iY{0}; iY < rows; ++iY)
+					for(int iX{0}; iX < cols; ++iX) tiles[getIdx(iX, iY)] = static_cast<bool>(mFn(iX, iY));
+			}
+
+			inline void clear()
+			{
+				for(const auto& e : bodies) if(auto* b = getBody(e)) b->destroy();
+				bodies.clear();
+			}
+
+			// Replaces the merged bodies with new ones matching the bitmap; `mFn(body)` is called on every new body (e.g. to set its groups)
+			template<typename TF> inline void rebuild(TF mFn)
+			{
+				clear();
+
+				std::vector<std::uint8_t> merged(tiles.size(), 0);
+				auto isFree([this, &merged](int mX, int mY){ const auto idx(getIdx(mX, mY)); return tiles[idx] != 0 && merged[idx] == 0; });
+
+				for(int iY{0}; iY < rows; ++iY)
+					for(int iX{0}; iX < cols; ++iX)
+					{
+						if(!isFree(iX, iY)) continue;
+
+						int width{1}, height{1};
+						while(iX + width < cols && isFree(iX + width, iY)) ++width;
+						for(; iY + height < rows; ++height)
+						{
+							bool rowFree{true};
+							for(int x{iX}; x < iX + width && rowFree; ++x) rowFree = isFree(x, iY + height);
+							if(!rowFree) break;
+						}
+
+						for(int y{iY}; y < iY + height; ++y)
+							for(int x{iX}; x < iX + width; ++x) merged[getIdx(x, y)] = 1;
+
+						const Vec2i size{width * tileSize, height * tileSize};
+						auto& body(world.create(origin + Vec2i{iX, iY} * tileSize + size / 2, size, true));
+						mFn(body);
+						bodies.emplace_back(body.getHandle(), world.getBodyStore().getGeneration(body.getHandle()));
+					}
+			}
+			inline void rebuild() { rebuild([](BodyType&){ }); }
+
+			inline bool isIdxValid(int mX, int mY) const noexcept	{ return mX >= 0 && mY >= 0 && mX < cols && mY < rows; }
+			inline bool isSolid(int mX, int mY) const noexcept		{ return isIdxValid(mX, mY) && tiles[getIdx(mX, mY)] != 0; }
+
+			// Tiles are half-open: a point on the edge between two tiles belongs to the right (or bottom) one
+			inline Vec2i getTileIdx(const Vec2f& mPos) const noexcept
+			{
+				return {static_cast<int>(std::floor((mPos.x - origin.x) / tileSize)), static_cast<int>(std::floor((mPos.y - origin.y) / tileSize))};
+			}
+			inline bool isSolidAt(const Vec2f& mPos) const noexcept { const auto idx(getTileIdx(mPos)); return isSolid(idx.x, idx.y); }
+
+			// Walks the tiles crossed by the ray in order (Amanatides-Woo) and returns the first solid one, along with the normal of the edge the ray
+			// entered it through; rays starting in a solid tile hit it at distance 0, with a null normal
+			inline TileHit raycast(const Ray& mRay) const noexcept
+			{
+				TileHit result;
+
+				const auto length(std::sqrt(mRay.dir.x * mRay.dir.x + mRay.dir.y * mRay.dir.y));
+				if(length == 0) return result;
+
+				const Vec2f dir{mRay.dir / length};
+				const auto size(ssvu::toFloat(tileSize)), inf(ssvu::NumLimits<float>::max());
+				const float left(origin.x), top(origin.y), right{left + cols * size}, bottom{top + rows * size};
+				const int stepX{dir.x > 0 ? 1 : dir.x < 0 ? -1 : 0}, stepY{dir.y > 0 ? 1 : dir.y < 0 ? -1 : 0};
+
+				// Rays starting outside of the layer are moved to where they enter it
+				const float enterX{stepX > 0 ? (left - mRay.origin.x) / dir.x : stepX < 0 ? (right - mRay.origin.x) / dir.x : -inf};
+				const float enterY{stepY > 0 ? (top - mRay.origin.y) / dir.y : stepY < 0 ? (bottom - mRay.origin.y) / dir.y : -inf};
+				const float exitX{stepX > 0 ? (right - mRay.origin.x) / dir.x : stepX < 0 ? (left - mRay.origin.x) / dir.x : inf};
+				const float exitY{stepY > 0 ? (bottom - mRay.origin.y) / dir.y : stepY < 0 ? (top - mRay.origin.y) / dir.y : inf};
+
+				if(stepX == 0 && (mRay.origin.x < left || mRay.origin.x >= right)) return result;
+				if(stepY == 0 && (mRay.origin.y < top || mRay.origin.y >= bottom)) return result;
+
+				auto t(std::max({0.f, enterX, enterY}));
+				if(t >= std::min(exitX, exitY) || t > mRay.maxDist) return result;
+
+				Vec2i normal;
+				if(t > 0) normal = enterX > enterY ? Vec2i{-stepX, 0} : Vec2i{0, -stepY};
+
+				const auto start(mRay.origin + dir * t);
+				auto idx(getTileIdx(start));
+				idx.x = ssvu::getClamped(idx.x, 0, cols - 1);
+				idx.y = ssvu::getClamped(idx.y, 0, rows - 1);
+
+				const float deltaX{stepX != 0 ? size / std::abs(dir.x) : inf}, deltaY{stepY != 0 ? size / std::abs(dir.y) : inf};
+				float maxX{stepX > 0 ? (left + (idx.x + 1) * size - mRay.origin.x) / dir.x : stepX < 0 ? (left + idx.x * size - mRay.origin.x) / dir.x : inf};
+				float maxY{stepY > 0 ? (top + (idx.y + 1) * size - mRay.origin.y) / dir.y : stepY < 0 ? (top + idx.y * size - mRay.origin.y) / dir.y : inf};
+
+				while(true)
+				{
+					if(tiles[getIdx(idx.x, idx.y)] != 0)
+					{
+						result = {true, idx, normal, t, mRay.origin + dir * t};
+						return result;
+					}
+
+					if(maxX < maxY)	{ t = maxX; maxX += deltaX; idx.x += stepX; normal = {-stepX, 0}; }
+					else			{ t = maxY; maxY += deltaY; idx.y += stepY; normal = {0, -stepY}; }
+
+					if(t > mRay.maxDist || !isIdxValid(idx.x, idx.y)) return result;
+				}
+			}
+
+			// Axis-aligned raycast; `mDir` must be one of `(1, 0)`, `(-1, 0)`, `(0, 1)` and `(0, -1)`
+			inline TileHit castOrtho(const Vec2f& mPos, const Vec2i& mDir, float mMaxDist = ssvu::NumLimits<float>::max()) const noexcept
+			{
+				SSVU_ASSERT(std::abs(mDir.x) + std::abs(mDir.y) == 1);
+				return raycast({mPos, Vec2f(mDir), mMaxDist});
+			}
+
+			inline const auto& getOrigin() const noexcept	{ return origin; }
+			inline int getTileSize() const noexcept			{ return tileSize; }
+			inline int getCols() const noexcept				{ return cols; }
+			inline int getRows() const noexcept				{ return rows; }
+
+			// Calls `mFn(body)` for every merged body still in the world
+			template<typename TF> inline void forEachBody(TF mFn) const { for(const auto& e : bodies) if(auto* b = getBody(e)) mFn(*b); }
+	};
+}
+
+#endif
@@ -12,6 +12,44 @@ namespace ssvsc
 	template<typename TW> class Sensor;
 	template<typename TW> struct DetectionInfo;
 	template<typename TW> struct ResolutionInfo;
+	template<typename TW> struct ContactInfo;
+	template<typename TW> struct SensorDetectionInfo;
+	template<typename TW> struct BodyStore;
+	class StaticLevel;
+
+	// Sleeping is opt-in: once enabled, a non-static body falls asleep after resting for `frames` consecutive frames, with its speed at most
+	// `velocityThreshold` and its last resolution at most `resolutionThreshold` on both axes
+	// Sleeping bodies are neither integrated nor checked for collisions, but stay in the spatial structure, so other bodies still collide with them
+	// They wake when touched by a body faster than `velocityThreshold`, when their position, velocity, size or acceleration are changed
+	// (so constant forces such as gravity should not be applied to sleeping bodies), or when a body they were resting against wakes or is destroyed
+	struct SleepSettings
+	{
+		bool enabled{false};
+		float velocityThreshold{0.1f};
+		int resolutionThreshold{1};
+		SizeT frames{60};
+	};
+
+	// Contact tracking is opt-in: once enabled, overlapping pairs are kept in a persistent cache across frames, firing `onContactBegin` when a pair
+	// starts overlapping and `onContactEnd` when it stops; `onContactStay` also fires on the frames in between with `stayEvents`
+	// Tracked pairs fire `onDetection` on their first frame only, unless `detectionEveryFrame` is set; without tracking, it fires on every frame of an overlap
+	struct ContactSettings
+	{
+		bool enabled{false};
+		bool stayEvents{false};
+		bool detectionEveryFrame{false};
+	};
+
+	namespace Impl
+	{
+		// Spatial types rebuilding their contents from scratch every frame get `refresh` called after integration, and force the phased update
+		// Spatial types keeping static bodies in a separate layer get `bakeStatics` called at the start of every update
+		// Spatial types able to bin many bodies at once get `rebuild` called by `World::restore`, instead of having every body removed and inserted again
+		// Spatial types accepting a `StaticLevel` get the proxies of the level contacts of a snapshot created again by `World::restore`
+		// Spatial types inserting shapes in batches get the bodies created since the last update joined all at once, before any body steps,
+		// as with the phased update, instead of one by one during the first step of each body
+		template<typename TS> struct SpatialTraits { static constexpr bool rebuildsEachFrame{false}, bakesStatics{false}, rebuildsInBulk{false}, hasStaticLevels{false}, joinsInBulk{false}; };
+	}
 
 	template<template<typename> class TS, template<typename> class TR> class World
 	{
@@ -25,41 +63,469 @@ namespace ssvsc
 			using SensorType = Sensor<World>;
 			using DetectionInfoType = DetectionInfo<World>;
 			using ResolutionInfoType = ResolutionInfo<World>;
+			using ContactInfoType = ContactInfo<World>;
+			using SensorDetectionInfoType = SensorDetectionInfo<World>;
+			using BodyStoreType = BodyStore<World>;
 			friend BaseType;
 			friend BodyType;
 			friend SensorType;
+			friend SpatialInfoType;
 
 		private:
+			// Must outlive `bodies`, as bodies release their slot on destruction
+			BodyStoreType bodyStore;
 			ssvu::MonoManager<BodyType> bodies;
 			ssvu::MonoManager<SensorType> sensors;
 
 			SpatialType spatial;
 			ResolverType resolver;
+			SizeT frame{0};
+			SleepSettings sleepSettings;
+			ContactSettings contactSettings;
+			Impl::StatsRecorder stats;
+			Impl::ContactCache<World> contacts;
+
+			// One event buffer per worker: worker buffers are only written to by parallel resolution, and merged into the first one after it
+			EventDispatch eventDispatch{EventDispatch::Inline};
+			std::vector<Impl::EventBuffer<World>> eventBuffers;
+			Impl::EventBuffer<World> eventScratch;
+			bool resolvingInParallel{false};
+
+			UPtr<Impl::ThreadPool> threadPool;
+			Impl::Islands islands;
+			std::vector<BodyType*> stepped;
+			std::vector<SizeT> steppedIdxs, stepOrders;
+			static constexpr SizeT null{ssvu::NumLimits<SizeT>::max()};
+			static constexpr SizeT integrateRangeSize{1024};
+			static constexpr std::uint32_t snapshotMagic{0x53435353}, snapshotVersion{1};
+			static constexpr std::uint32_t frozenMagic{0x46435353}, frozenVersion{1};
 
 			inline void delBody(BodyType* mBase) noexcept		{ SSVU_ASSERT(mBase != nullptr); bodies.del(*mBase); }
 			inline void delSensor(SensorType* mBase) noexcept	{ SSVU_ASSERT(mBase != nullptr); sensors.del(*mBase); }
 
+			// Proxies are created by the spatial info of the body (or sensor) touching the level entry, during detection, and by `restore` for the
+			// contacts of the snapshot involving one; the grid's proxy table is checked against the body store, as the proxy may have been destroyed since
+			inline BodyType& getLevelProxy(std::uint32_t mId)
+			{
+				auto& proxy(spatial.getLevelProxies()[mId]);
+				if(bodyStore.isAlive(proxy.handle) && bodyStore.getGeneration(proxy.handle) == proxy.generation) return *bodyStore.owners[bodyStore.getIdx(proxy.handle)];
+
+				const auto& level(*spatial.getStaticLevel());
+				auto& body(bodies.create(*this, mId, level.getShape(mId), level.getGroups(mId), level.getGroupsToCheck(mId)));
+				proxy = {body.getHandle(), bodyStore.getGeneration(body.getHandle())};
+				return body;
+			}
+			inline BodyType* findLevelProxy(std::uint32_t mId, std::true_type)
+			{
+				const auto* level(spatial.getStaticLevel());
+				return level != nullptr && mId < level->getBodyCount() ? &getLevelProxy(mId) : nullptr;
+			}
+			inline BodyType* findLevelProxy(std::uint32_t, std::false_type) noexcept { return nullptr; }
+
+			// Calls `mFn(shape, getProxy)` for every entry of the attached `StaticLevel` overlapping `mRegion`, where `getProxy()` materialises the entry
+			template<typename TF> inline void forEachLevelEntry(const AABB& mRegion, TF mFn, std::true_type)
+			{
+				const auto* level(spatial.getStaticLevel());
+				if(level != nullptr) level->forEachOverlapping(mRegion, [this, level, &mFn](std::uint32_t mId){ mFn(level->getShape(mId), [this, mId]() -> BodyType& { return getLevelProxy(mId); }); });
+			}
+			template<typename TF> inline void forEachLevelEntry(const AABB&, TF, std::false_type) noexcept { }
+			template<typename TF> inline void forEachLevelEntry(const AABB& mRegion, TF mFn)
+			{
+				forEachLevelEntry(mRegion, mFn, std::integral_constant<bool, Impl::SpatialTraits<SpatialType>::hasStaticLevels>{});
+			}
+
+			inline bool isDeferringEvents() const noexcept { return eventDispatch != EventDispatch::Inline; }
+			inline auto& getEventBuffer() noexcept { return eventBuffers[resolvingInParallel ? Impl::ThreadPool::getCurrentWorker() : 0]; }
+
+			template<typename TF> inline void runJob(SizeT mCount, TF& mFn)
+			{
+				if(threadPool != nullptr) { threadPool->run(mCount, mFn); return; }
+				for(auto i(0u); i < mCount; ++i) mFn(i);
+			}
+
+			inline void updateBodiesPhased(FT mFT)
+			{
+				stepped.clear();
+				for(const auto& b : bodies)
+				{
+					if(!b->beginStep()) continue;
+					stepped.emplace_back(b.get());
+					bodyStore.setFlag(b->getStoreIdx(), BodyFlag::Stepping, true);
+				}
+
+				{
+					SSVSC_STATS_TRACE(*this, StatsPhase::Integrate);
+
+					// The store is integrated in ranges of indices, one array page each; integrated shapes are then handed to the spatial info right away,
+					// as other bodies may detect this one before it runs its own detection
+					const auto rangeCount((bodyStore.getSize() + integrateRangeSize - 1) / integrateRangeSize);
+					auto integrate([this, mFT](SizeT mRange){ bodyStore.integrate(mRange * integrateRangeSize, std::min((mRange + 1) * integrateRangeSize, bodyStore.getSize()), mFT); });
+					runJob(rangeCount, integrate);
+
+					auto postIntegrate([this](SizeT mIdx){ stepped[mIdx]->getSpatialInfo().template postUpdate<BodyTag>(); });
+					runJob(stepped.size(), postIntegrate);
+				}
+
+				{
+					SSVSC_STATS_TRACE(*this, StatsPhase::SpatialUpdate);
+					refreshSpatial(std::integral_constant<bool, Impl::SpatialTraits<SpatialType>::rebuildsEachFrame>{});
+				}
+
+				{
+					SSVSC_STATS_EVENT(*this, "detect");
+					for(const auto& b : stepped) b->detect(mFT);
+				}
+
+				{
+					SSVSC_STATS_TRACE(*this, StatsPhase::Resolution);
+
+					// Like in the serial update, where later bodies have not moved yet when a body resolves, bodies do not resolve against
+					// bodies stepped after them: those resolve against the earlier ones instead, after them
+					stepOrders.assign(bodyStore.getSize(), SizeT(null));
+					for(auto i(0u); i < stepped.size(); ++i) stepOrders[stepped[i]->getStoreIdx()] = i;
+					for(auto i(0u); i < stepped.size(); ++i)
+						ssvu::eraseRemoveIf(stepped[i]->toResolve, [this, i](BodyType* mBody){ const auto order(stepOrders[mBody->getStoreIdx()]); return order != null && order > i; });
+
+					// Bodies resolving against each other end up in the same island; static bodies are never written to, so they do not link islands
+					islands.reset(bodyStore.getSize());
+					steppedIdxs.clear();
+					for(const auto& b : stepped)
+					{
+						steppedIdxs.emplace_back(b->getStoreIdx());
+						SSVSC_STATS_COUNT(*this, resolutions, b->toResolve.size());
+						for(const auto& r : b->toResolve) if(!r->isStatic()) islands.join(steppedIdxs.back(), r->getStoreIdx());
+					}
+					islands.build(steppedIdxs);
+
+					auto resolve([this](SizeT mIsland){ for(auto i(islands.begin(mIsland)); i != islands.end(mIsland); ++i) stepped[*i]->resolve(); });
+					const auto eventsBegin(eventBuffers[0].getSize());
+					resolvingInParallel = threadPool != nullptr;
+					runJob(islands.getCount(), resolve);
+					resolvingInParallel = false;
+
+					// Every body records all of its resolution events on a single thread: putting them back in step order gives the order of a single-threaded run
+					if(threadPool != nullptr && isDeferringEvents())
+					{
+						for(auto i(1u); i < eventBuffers.size(); ++i) eventBuffers[0].append(eventBuffers[i]);
+						eventBuffers[0].sortByReceiver(eventsBegin, [this](BaseType& mReceiver){ return stepOrders[ssvu::castUp<BodyType>(mReceiver).getStoreIdx()]; }, eventScratch);
+					}
+				}
+
+				for(const auto& b : stepped) { bodyStore.setFlag(b->getStoreIdx(), BodyFlag::Stepping, false); b->endStep(); }
+			}
+
+			inline void updateBodiesSerial(FT mFT)
+			{
+				SSVSC_STATS_EVENT(*this, "bodies");
+				for(const auto& b : bodies) b->update(mFT);
+			}
+
+			inline void refreshSpatial(std::true_type) { spatial.refresh([this](SizeT mCount, auto& mFn){ runJob(mCount, mFn); }); }
+			inline void refreshSpatial(std::false_type) noexcept { }
+			inline void joinNewBodies(std::true_type)
+			{
+				for(const auto& b : bodies) if(b->mustInit) { b->getSpatialInfo().template init<BodyTag>(); b->mustInit = false; }
+			}
+			inline void joinNewBodies(std::false_type) noexcept { }
+			inline void bakeStatics(std::true_type) { spatial.bakeStatics(); }
+			inline void bakeStatics(std::false_type) noexcept { }
+			inline void rebuildSpatial(const std::vector<BodyType*>& mBodies, std::true_type) { spatial.rebuild(mBodies); }
+			inline void rebuildSpatial(const std::vector<BodyType*>& mBodies, std::false_type)
+			{
+				for(const auto& b : mBodies) b->getSpatialInfo().template destroy<BodyTag>();
+				for(const auto& b : mBodies) b->getSpatialInfo().template init<BodyTag>();
+			}
+
 		public:
-			template<typename... TArgs> inline World(TArgs&&... mArgs) : spatial{FWD(mArgs)...} { }
+			template<typename... TArgs> inline World(TArgs&&... mArgs) : spatial{FWD(mArgs)...}, eventBuffers(1) { }
 			inline ~World() noexcept { clear(); }
 
 			inline auto& create(const Vec2i& mPos, const Vec2i& mSize, bool mStatic)	{ return bodies.create(*this, mStatic, mPos, mSize); }
 			inline auto& createSensor(const Vec2i& mPos, const Vec2i& mSize)			{ return sensors.create(*this, mPos, mSize); }
 
 			inline void update(FT mFT)
+			{
+				++frame;
+				SSVSC_STATS_BEGIN_FRAME(*this);
+
+				{
+					SSVSC_STATS_TRACE(*this, StatsPhase::Refresh);
+					bodies.refresh();
+					sensors.refresh();
+					joinNewBodies(std::integral_constant<bool, Impl::SpatialTraits<SpatialType>::joinsInBulk>{});
+					bakeStatics(std::integral_constant<bool, Impl::SpatialTraits<SpatialType>::bakesStatics>{});
+				}
+
+				{
+					SSVSC_STATS_TRACE(*this, StatsPhase::Sensors);
+					for(const auto& s : sensors) s->beginStep();
+				}
+
+				if(threadPool == nullptr && !Impl::SpatialTraits<SpatialType>::rebuildsEachFrame) updateBodiesSerial(mFT);
+				else updateBodiesPhased(mFT);
+
+				if(contactSettings.enabled) contacts.endStale(bodyStore, frame);
+
+				{
+					SSVSC_STATS_TRACE(*this, StatsPhase::Sensors);
+					for(const auto& s : sensors) s->detect(mFT);
+				}
+
+				{
+					SSVSC_STATS_TRACE(*this, StatsPhase::PostUpdate);
+					resolver.postUpdate(*this);
+				}
+
+				if(isDeferringEvents())
+				{
+					SSVSC_STATS_EVENT(*this, "events");
+					if(eventDispatch == EventDispatch::DeferredByBody) eventBuffers[0].groupByReceiver(eventScratch);
+					eventBuffers[0].dispatch(mFT);
+				}
+
+				SSVSC_STATS_END_FRAME(*this);
+			}
+			inline void clear() noexcept { bodies.clear(); sensors.clear(); contacts.clear(); }
+
+			// Attaches a `StaticLevel` (or detaches it, with `nullptr`) to a grid spatial type; it must have been baked for the grid's layout,
+			// and outlive the world (or stay attached until it is detached). Proxy bodies of the previous level are destroyed
+			inline void setStaticLevel(const StaticLevel* mLevel)
 			{
 				bodies.refresh();
-				sensors.refresh();
-				for(const auto& b : bodies) b->update(mFT);
-				for(const auto& s : sensors) s->update(mFT);
-				resolver.postUpdate(*this);
+				for(const auto& b : bodies) if(b->isProxy()) b->destroy();
+				bodies.refresh();
+				spatial.setStaticLevel(mLevel);
 			}
-			inline void clear() noexcept { bodies.clear(); sensors.clear(); }
+
+			// Destroys the proxy bodies of the attached `StaticLevel` which were not part of any pair for at least `mIdleFrames` frames
+			// (they are created again on demand); call this periodically to bound the memory of worlds whose bodies roam over large levels
+			inline void releaseLevelProxies(SizeT mIdleFrames)
+			{
+				for(const auto& b : bodies) if(b->isProxy() && frame - b->pairFrame >= mIdleFrames) b->destroy();
+			}
+
+			// Writes the simulation state of every body to `mOut` as a versioned binary blob: store data, flags, groups, resolver info, sleep and
+			// contact bookkeeping, along with the frame counter and the handle table; sensors, callbacks, user data and settings are not part of it,
+			// nor are the proxies of a `StaticLevel`, which restored worlds create again on demand (or right away, for the ones in contact with a body)
+			// Bodies created or destroyed since the last update are taken into account first; must not be called while the world is updating
+			inline void snapshot(std::vector<char>& mOut)
+			{
+				bodies.refresh();
+				mOut.clear();
+
+				Impl::BlobWriter writer{mOut};
+				writer.write(snapshotMagic);
+				writer.write(snapshotVersion);
+				writer.write(std::uint64_t(frame));
+
+				SizeT count{0};
+				for(const auto& b : bodies) if(!b->isProxy()) ++count;
+
+				writer.write(std::uint64_t(count));
+				for(const auto& b : bodies) if(!b->isProxy()) { writer.write(std::uint64_t(b->getHandle())); writer.write(bodyStore.getGeneration(b->getHandle())); }
+				bodyStore.writeHandles(writer, [this](BodyHandle mHandle){ return !bodyStore.owners[bodyStore.getIdx(mHandle)]->isProxy(); });
+				for(const auto& b : bodies) if(!b->isProxy()) b->writeState(writer, [](const BodyType& mBody){ return mBody.getHandle(); });
+				contacts.write(bodyStore, writer);
+			}
+
+			// Brings the bodies back to the state of a `snapshot`, without firing any event
+			// Throws `std::runtime_error` on invalid blobs: the world is left untouched if the header or the body list is invalid, and in a valid but unspecified state otherwise
+			// Bodies of the snapshot still alive (same handle and generation) are restored in place, keeping their callbacks and user data; other
+			// live bodies are destroyed, and the snapshot's bodies missing from the world are recreated with their original handle, and passed to `mFn`
+			// Recreated bodies are updated after the other bodies; the spatial structure is rebuilt from all bodies in snapshot order (in a single pass
+			// for grids), so that the state of the world after a restore only depends on the snapshot and on the order of the bodies which were kept
+			template<typename TF> inline void restore(const char* mData, SizeT mSize, TF mFn)
+			{
+				Impl::BlobReader reader{mData, mSize};
+				if(reader.read<std::uint32_t>() != snapshotMagic) throw std::runtime_error{"ssvsc::World::restore: not a world snapshot"};
+				if(reader.read<std::uint32_t>() != snapshotVersion) throw std::runtime_error{"ssvsc::World::restore: unsupported snapshot version"};
+
+				const auto snapshotFrame(reader.read<std::uint64_t>());
+				std::vector<std::pair<BodyHandle, std::uint32_t>> ids(reader.readCount(sizeof(std::uint64_t) + sizeof(std::uint32_t)));
+				Impl::FlatHashMap<BodyHandle, std::uint32_t> generations;
+				generations.reserve(ids.size());
+				for(auto& id : ids)
+				{
+					id = {reader.read<std::uint64_t>(), reader.read<std::uint32_t>()};
+					if(id.first > 0xFFFFFFFFu || generations.find(id.first) != nullptr) throw std::runtime_error{"ssvsc::World::restore: invalid body handle"};
+					generations[id.first] = id.second;
+				}
+
+				bodies.refresh();
+				for(const auto& b : bodies)
+				{
+					const auto h(b->getHandle());
+					const auto generation(generations.find(h));
+					if(generation == nullptr || *generation != bodyStore.getGeneration(h)) b->destroy();
+				}
+				bodies.refresh();
+
+				std::vector<BodyType*> created;
+				for(const auto& id : ids) if(!bodyStore.isAlive(id.first)) created.emplace_back(&bodies.create(*this, id.first, id.second));
+
+				bodyStore.readHandles(reader);
+				auto getBody([this](std::uint64_t mHandle){ return bodyStore.isAlive(mHandle) ? bodyStore.owners[bodyStore.getIdx(mHandle)] : nullptr; });
+				for(const auto& id : ids) bodyStore.owners[bodyStore.getIdx(id.first)]->readState(reader, getBody);
+				contacts.read(bodyStore, reader, [this](std::uint32_t mId){ return findLevelProxy(mId, std::integral_constant<bool, Impl::SpatialTraits<SpatialType>::hasStaticLevels>{}); });
+				if(!reader.isAtEnd()) throw std::runtime_error{"ssvsc::World::restore: trailing data"};
+				if(!contactSettings.enabled) contacts.clear();
+
+				frame = snapshotFrame;
+				std::vector<BodyType*> restored(ids.size());
+				for(auto i(0u); i < ids.size(); ++i) restored[i] = bodyStore.owners[bodyStore.getIdx(ids[i].first)];
+				rebuildSpatial(restored, std::integral_constant<bool, Impl::SpatialTraits<SpatialType>::rebuildsInBulk>{});
+
+				for(const auto& b : restored)
+				{
+					b->mustInit = false;
+
+					// Like at the end of a step, bodies which moved during their last step get their spatial info recomputed before their next detection
+					if(b->getOldShape() != b->getShape()) b->getSpatialInfo().invalidate();
+				}
+
+				for(const auto& b : created) mFn(*b);
+			}
+			inline void restore(const char* mData, SizeT mSize)	{ restore(mData, mSize, [](BodyType&){ }); }
+			inline void restore(const std::vector<char>& mData)	{ restore(mData.data(), mData.size()); }
+
+			// Writes the simulation state of `mBodies` to `mOut` (like `snapshot`, but without handles, nor the contact cache) and destroys them
+			// Resting contacts between frozen bodies are kept, while bodies resting against one of them from outside lose their support
+			// Frozen bodies are destroyed, as with `destroy`; they come back as new bodies (with new handles, and no callbacks nor user data) with `thaw`
+			// `mBodies` must only contain live, distinct bodies which are not proxies; must not be called while the world is updating
+			inline void freeze(const std::vector<BodyType*>& mBodies, std::vector<char>& mOut)
+			{
+				Impl::FlatHashMap<BodyHandle, SizeT> ids;
+				ids.reserve(mBodies.size());
+				for(auto i(0u); i < mBodies.size(); ++i)
+				{
+					SSVU_ASSERT(mBodies[i]->isAlive() && !mBodies[i]->isProxy() && ids.find(mBodies[i]->getHandle()) == nullptr);
+					ids[mBodies[i]->getHandle()] = i;
+				}
+
+				mOut.clear();
+				Impl::BlobWriter writer{mOut};
+				writer.write(frozenMagic);
+				writer.write(frozenVersion);
+				writer.write(std::uint64_t(mBodies.size()));
+				for(const auto& b : mBodies) b->writeState(writer, [&ids](const BodyType& mBody){ const auto id(ids.find(mBody.getHandle())); return id == nullptr ? null : *id; });
+
+				for(const auto& b : mBodies) b->destroy();
+			}
+
+			// Creates back the bodies of a `freeze` blob, in the order they were frozen, and passes each of them to `mFn` once all of them are restored
+			// Like bodies returned by `create`, they join the world on the next update; their frame counters are kept as they were when frozen
+			// Throws `std::runtime_error` on invalid blobs: nothing is created if the header is invalid, and the world is left in a valid but unspecified state otherwise
+			template<typename TF> inline void thaw(const char* mData, SizeT mSize, TF mFn)
+			{
+				Impl::BlobReader reader{mData, mSize};
+				if(reader.read<std::uint32_t>() != frozenMagic) throw std::runtime_error{"ssvsc::World::thaw: not a frozen body blob"};
+				if(reader.read<std::uint32_t>() != frozenVersion) throw std::runtime_error{"ssvsc::World::thaw: unsupported frozen body blob version"};
+
+				std::vector<BodyType*> thawed(reader.readCount(sizeof(AABB)));
+				for(auto& b : thawed) b = &bodies.create(*this, false, Vec2i{}, Vec2i{});
+
+				auto getBody([&thawed](std::uint64_t mId){ return mId < thawed.size() ? thawed[mId] : nullptr; });
+				for(const auto& b : thawed) b->readState(reader, getBody);
+				if(!reader.isAtEnd()) throw std::runtime_error{"ssvsc::World::thaw: trailing data"};
+
+				for(const auto& b : thawed) mFn(*b);
+			}
+			inline void thaw(const char* mData, SizeT mSize)	{ thaw(mData, mSize, [](BodyType&){ }); }
+			inline void thaw(const std::vector<char>& mData)	{ thaw(mData.data(), mData.size()); }
+
+			inline void setSleepSettings(const SleepSettings& mSettings)
+			{
+				sleepSettings = mSettings;
+				if(!sleepSettings.enabled) for(const auto& b : bodies) b->wake();
+			}
+
+			// Disabling contact tracking forgets every tracked pair, without firing `onContactEnd`
+			inline void setContactSettings(const ContactSettings& mSettings)
+			{
+				contactSettings = mSettings;
+				if(!contactSettings.enabled) contacts.clear();
+			}
+
+			// With more than one thread, bodies are stepped in phases instead of one after the other:
+			// 1. `onPreUpdate` callbacks run serially, in body order (after the ones of sensors, which always run first)
+			// 2. All moving bodies integrate in parallel
+			// 3. Serially, in body order, every moving body updates its spatial info and detects collisions against the positions of step 2
+			// 4. Bodies are split into islands (bodies linked by resolution pairs); islands are resolved in parallel, and bodies inside an island are resolved in body order,
+			//    each one only against static bodies, bodies that did not move and moving bodies before it in body order
+			// 5. Spatial info updates and `onPostUpdate` callbacks run serially, in body order, followed by sensors and the resolver
+			// The result only depends on body order, never on the thread count; `onResolution` callbacks may be called concurrently from different threads
+			// Spatial types rebuilt every frame (e.g. `RebuildGrid`) always use this phased update, and get rebuilt between steps 2 and 3
+			inline void setThreadCount(SizeT mCount)
+			{
+				threadPool = mCount > 1 ? ssvu::makeUPtr<Impl::ThreadPool>(mCount) : nullptr;
+				eventBuffers.resize(std::max(mCount, SizeT(1)));
+			}
+
+			// See `EventDispatch`; must not be changed while the world is updating
+			inline void setEventDispatch(EventDispatch mDispatch) noexcept { eventDispatch = mDispatch; }
 
 			inline const auto& getBodies() const noexcept	{ return bodies; }
+			inline const auto& getBodyStore() const noexcept	{ return bodyStore; }
 			inline const auto& getSensors() const noexcept	{ return sensors; }
 			inline const auto& getSpatial() const noexcept	{ return spatial; }
+			inline auto& getSpatial() noexcept				{ return spatial; }
 			inline const auto& getResolver() const noexcept	{ return resolver; }
+			inline SizeT getFrame() const noexcept			{ return frame; }
+			inline const auto& getSleepSettings() const noexcept	{ return sleepSettings; }
+			inline const auto& getContactSettings() const noexcept	{ return contactSettings; }
+			inline SizeT getContactCount() const noexcept	{ return contacts.getSize(); }
+			inline EventDispatch getEventDispatch() const noexcept	{ return eventDispatch; }
+			inline SizeT getThreadCount() const noexcept	{ return threadPool == nullptr ? 1 : threadPool->getWorkerCount(); }
+
+			// Stats of the last update; requires `SSVSC_ENABLE_STATS`, see `Stats`
+			inline const Stats& getStats() const noexcept	{ return stats.getLast(); }
+
+			// While tracing, every update records one Chrome trace event per phase; `writeStatsTrace` dumps all of them as JSON
+			inline void setStatsTracing(bool mTracing) noexcept		{ stats.setTracing(mTracing); }
+			inline void clearStatsTrace() noexcept					{ stats.clearTrace(); }
+			inline void writeStatsTrace(std::ostream& mStream) const	{ stats.writeTrace(mStream); }
+
+			// Calls `mFn(body)` once for every body overlapping `mRegion`; with `mGroups`, only for bodies belonging to any of them (checked before anything else)
+			template<typename TF> inline void forEachOverlapping(const AABB& mRegion, const GroupBitset& mGroups, const TF& mFn) const
+			{
+				spatial.forEachOverlapping(mRegion, [&mGroups](const BodyType& mBody){ return mBody.hasAnyGroup(mGroups); }, mFn);
+			}
+			template<typename TF> inline void forEachOverlapping(const AABB& mRegion, const TF& mFn) const
+			{
+				spatial.forEachOverlapping(mRegion, [](const BodyType&){ return true; }, mFn);
+			}
+
+			// Fills `mOut` with the (at most) `mK` bodies passing `mFilter` closest to `mPos`, sorted by distance from `mPos` to their shape
+			// Bodies farther than `mMaxDist` are ignored; the search stops expanding as soon as nothing unvisited can beat the current `mK`-th result
+			// `mOut` is cleared first: reusing it across calls avoids allocations
+			template<typename TF> inline void nearest(const Vec2f& mPos, SizeT mK, const TF& mFilter, std::vector<NearestHit<World>>& mOut, float mMaxDist = ssvu::NumLimits<float>::max()) const
+			{
+				Impl::NearestHeap<World> heap{mOut, mK, mMaxDist};
+				if(mK == 0) return;
+
+				spatial.forEachNear(mPos, [&heap]{ return heap.getBoundSquared(); }, mFilter, [&heap, &mPos](BodyType& mBody){ heap.add(mBody, Impl::getDistSquared(mBody.getShape(), mPos)); });
+				heap.finish();
+			}
+			inline void nearest(const Vec2f& mPos, SizeT mK, std::vector<NearestHit<World>>& mOut, float mMaxDist = ssvu::NumLimits<float>::max()) const
+			{
+				nearest(mPos, mK, [](const BodyType&){ return true; }, mOut, mMaxDist);
+			}
+
+			// Casts `mCount` rays against the bodies of a grid spatial type, writing the closest hit of `mRays[i]` (if any) to `mHits[i]`
+			// Packets of rays are spread across the threads set with `setThreadCount`; must not be called while the world is updating
+			template<typename TF> inline void raycastBatch(const Ray* mRays, RayHit<World>* mHits, SizeT mCount, TF mFilter)
+			{
+				const auto packetCount((mCount + Impl::rayPacketSize - 1) / Impl::rayPacketSize);
+				auto castPacket([this, mRays, mHits, mCount, &mFilter](SizeT mPacket)
+				{
+					const auto begin(mPacket * Impl::rayPacketSize);
+					Impl::castRayPacket<World>(spatial, bodyStore, mRays, mHits, begin, std::min(begin + Impl::rayPacketSize, mCount), mFilter);
+				});
+				runJob(packetCount, castPacket);
+			}
+			inline void raycastBatch(const Ray* mRays, RayHit<World>* mHits, SizeT mCount)				{ raycastBatch(mRays, mHits, mCount, [](const BodyType&){ return true; }); }
+			inline void raycastBatch(const Ray* mRays, RayHit<World>* mHits, SizeT mCount, Group mGroup)	{ raycastBatch(mRays, mHits, mCount, [mGroup](const BodyType& mBody){ return mBody.hasGroup(mGroup); }); }
+			inline void raycastBatch(const std::vector<Ray>& mRays, std::vector<RayHit<World>>& mHits)	{ mHits.resize(mRays.size()); raycastBatch(mRays.data(), mHits.data(), mRays.size()); }
 
 			template<QueryType TType, QueryMode TMode = QueryMode::All, typename... TArgs> inline auto getQuery(TArgs&&... mArgs) noexcept
 			{
@@ -0,0 +1,69 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Contact events follow `ContactSettings`: none without tracking, where `onDetection` fires every frame; with tracking, begin and end once per
+// overlap, stay events and per-frame detections only when asked for
+
+#include <string>
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "TestUtils.hpp"
+
+using namespace ssvsc;
+using namespace ssvsc::Tests;
+
+namespace
+{
+	using W = World<Grid, Retro>;
+
+	// Overlaps for three frames, then moves away for two
+	inline std::string getEvents(const ContactSettings& mSettings)
+	{
+		W world{40, 40, 32, 20};
+		world.setContactSettings(mSettings);
+		std::string events;
+
+		auto& b(world.create({10, 10}, {40, 40}, false));
+		auto& a(world.create({0, 0}, {40, 40}, true));
+		a.addGroups(0);
+		b.addGroups(0);
+		b.addGroupsToCheck(0);
+		b.setResolve(false);
+
+		b.onDetection += [&events](const DetectionInfo<W>&){ events += 'd'; };
+		b.onContactBegin += [&events](const ContactInfo<W>&){ events += 'b'; };
+		b.onContactStay += [&events](const ContactInfo<W>&){ events += 's'; };
+		b.onContactEnd += [&events](const ContactInfo<W>&){ events += 'e'; };
+
+		// Bodies join the spatial structure during their first step, after `b` looked for pairs
+		world.update(1.f);
+		events.clear();
+
+		for(auto f(0); f < 5; ++f)
+		{
+			if(f == 3) b.setPosition({200, 200});
+			world.update(1.f);
+			events += '|';
+		}
+
+		SSVSC_CHECK(world.getContactCount() == 0);
+		return events;
+	}
+}
+
+int main()
+{
+	setCase("disabled");
+	SSVSC_CHECK(getEvents({}) == "d|d|d|||");
+
+	setCase("enabled");
+	SSVSC_CHECK(getEvents({true, false, false}) == "db|||e||");
+
+	setCase("stay events");
+	SSVSC_CHECK(getEvents({true, true, false}) == "db|s|s|e||");
+
+	setCase("detection every frame");
+	SSVSC_CHECK(getEvents({true, true, true}) == "db|ds|ds|e||");
+
+	return getResult();
+}
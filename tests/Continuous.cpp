@@ -0,0 +1,66 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Continuous bodies do not tunnel through thin walls, whether the wall is a static body or an entry of a `StaticLevel`; non-continuous
+// bodies fast enough to skip over the wall in a single frame do
+
+#include <vector>
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "TestUtils.hpp"
+
+using namespace ssvsc;
+using namespace ssvsc::Tests;
+
+namespace
+{
+	enum class Wall { Body, Level };
+
+	// The wall is 4 units thick, and the body moves 300 units in a single frame, starting 200 units before it
+	const AABB wallShape{Vec2i{240, 40}, Vec2i{4, 80}};
+
+	// Returns the position of the moving body after the frame: it stopped against the wall if it is still on its left
+	template<template<typename> class TS> inline int getFinalX(Wall mWall, bool mContinuous)
+	{
+		using W = World<TS, Retro>;
+		W world{40, 40, 32, 20};
+
+		GroupBitset groups;
+		groups[0] = true;
+		std::vector<char> blob;
+		StaticLevel::bake(blob, 40, 40, 32, 20, {{wallShape, groups, {}}});
+		const LevelData data{blob};
+		const StaticLevel level{data.data, data.size};
+
+		if(mWall == Wall::Level) world.setStaticLevel(&level);
+		else world.create(wallShape.getPosition(), wallShape.getSize(), true).addGroups(0);
+
+		auto& b(world.create({40, 40}, {20, 20}, false));
+		b.addGroupsToCheck(0);
+		b.setContinuous(mContinuous);
+		world.update(1.f);
+
+		b.setVelocity({300.f, 0.f});
+		world.update(1.f);
+
+		const auto result(b.getPosition().x);
+		world.setStaticLevel(nullptr);
+		return result;
+	}
+
+	template<template<typename> class TS> inline void test(const char* mName)
+	{
+		setCase(mName);
+		SSVSC_CHECK(getFinalX<TS>(Wall::Body, true) < wallShape.getLeft());
+		SSVSC_CHECK(getFinalX<TS>(Wall::Level, true) < wallShape.getLeft());
+		SSVSC_CHECK(getFinalX<TS>(Wall::Body, false) > wallShape.getRight());
+		SSVSC_CHECK(getFinalX<TS>(Wall::Level, false) > wallShape.getRight());
+	}
+}
+
+int main()
+{
+	test<Grid>("Grid");
+	test<HashGrid>("HashGrid");
+	return getResult();
+}
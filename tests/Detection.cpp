@@ -0,0 +1,126 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Every overlapping pair fires `onDetection` exactly once per direction and frame, whatever the spatial type, the number of cells both bodies
+// share and the thread count; checked on a pair spanning many cells and against brute force on a still random scene
+
+#include <map>
+#include <utility>
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "TestUtils.hpp"
+
+using namespace ssvsc;
+using namespace ssvsc::Tests;
+
+namespace
+{
+	using Pair = std::pair<BodyHandle, BodyHandle>;
+
+	// Counts the detections of the last update, by (receiver, detected body)
+	template<typename TW> struct DetectionLog
+	{
+		std::map<Pair, int> counts;
+
+		inline void watch(Body<TW>& mBody)
+		{
+			mBody.onDetection += [this, &mBody](const DetectionInfo<TW>& mInfo){ ++counts[{mBody.getHandle(), mInfo.body.getHandle()}]; };
+		}
+	};
+
+	template<typename TW> inline Body<TW>& createStill(TW& mWorld, const Vec2i& mPos, const Vec2i& mSize, bool mStatic)
+	{
+		auto& b(mWorld.create(mPos, mSize, mStatic));
+		b.addGroups(0);
+		b.addGroupsToCheck(0);
+		b.setResolve(false);
+		return b;
+	}
+
+	// Two dynamic bodies sharing many cells, and a static one under both of them
+	template<typename TW> inline void testPair(TW& mWorld, SizeT mThreads)
+	{
+		mWorld.setThreadCount(mThreads);
+		DetectionLog<TW> log;
+
+		auto& a(createStill(mWorld, {0, 0}, {300, 300}, false));
+		auto& b(createStill(mWorld, {40, 40}, {300, 300}, false));
+		auto& s(createStill(mWorld, {0, 180}, {400, 100}, true));
+		for(auto* x : {&a, &b, &s}) log.watch(*x);
+
+		// Bodies join the spatial structure during their first step, so later bodies are only detected from the next update
+		mWorld.update(1.f);
+
+		for(auto f(0); f < 5; ++f)
+		{
+			log.counts.clear();
+			mWorld.update(1.f);
+
+			const std::map<Pair, int> expected
+			{
+				{{a.getHandle(), b.getHandle()}, 1}, {{b.getHandle(), a.getHandle()}, 1},
+				{{a.getHandle(), s.getHandle()}, 1}, {{s.getHandle(), a.getHandle()}, 1},
+				{{b.getHandle(), s.getHandle()}, 1}, {{s.getHandle(), b.getHandle()}, 1}
+			};
+			SSVSC_CHECK(log.counts == expected);
+		}
+	}
+
+	// Still bodies only detect what overlaps them at rest, so the detections of a frame are exactly the overlapping pairs with a dynamic body
+	// The scene is checked again after destroying a third of its bodies and creating new ones in the same frame
+	template<typename TW> inline void testBruteForce(TW& mWorld, SizeT mThreads)
+	{
+		mWorld.setThreadCount(mThreads);
+		DetectionLog<TW> log;
+		Rng rng{11};
+		auto createRandom([&](SizeT mCount)
+		{
+			for(auto i(0u); i < mCount; ++i) log.watch(createStill(mWorld, {getRandom(rng, -900, 900), getRandom(rng, -900, 900)}, {getRandom(rng, 4, 160), getRandom(rng, 4, 160)}, i % 4 == 0));
+		});
+
+		createRandom(600);
+		mWorld.update(1.f);
+
+		for(auto f(0); f < 6; ++f)
+		{
+			if(f == 3)
+			{
+				SizeT i{0};
+				for(const auto& b : mWorld.getBodies()) if(i++ % 3 == 0) b->destroy();
+				createRandom(200);
+				mWorld.update(1.f);
+			}
+
+			log.counts.clear();
+			mWorld.update(1.f);
+
+			std::map<Pair, int> expected;
+			for(const auto& x : mWorld.getBodies())
+				for(const auto& y : mWorld.getBodies())
+					if(x != y && (!x->isStatic() || !y->isStatic()) && x->getShape().isOverlapping(y->getShape())) expected[{x->getHandle(), y->getHandle()}] = 1;
+
+			SSVSC_CHECK(!expected.empty());
+			SSVSC_CHECK(log.counts == expected);
+		}
+	}
+
+	template<template<typename> class TS, typename... TArgs> inline void test(const char* mName, SizeT mThreads, const TArgs&... mArgs)
+	{
+		setCase(mName);
+		{ World<TS, Retro> world{mArgs...}; testPair(world, mThreads); }
+		{ World<TS, Retro> world{mArgs...}; testBruteForce(world, mThreads); }
+	}
+}
+
+int main()
+{
+	test<Grid>("Grid", 1, 80, 80, 32, 40);
+	test<Grid>("Grid, 4 threads", 4, 80, 80, 32, 40);
+	test<HashGrid>("HashGrid", 1, 80, 80, 32, 40);
+	test<RebuildGrid>("RebuildGrid", 1, 80, 80, 32, 40);
+	test<RebuildGrid>("RebuildGrid, 3 threads", 3, 80, 80, 32, 40);
+	test<ChunkedGrid>("ChunkedGrid", 1, 32, 8);
+	test<SweepAndPrune>("SweepAndPrune", 1);
+	test<AABBTree>("AABBTree", 1);
+	return getResult();
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Nearest queries, with filters and distance limits, checked against brute force over every body of random scenes
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "TestUtils.hpp"
+
+using namespace ssvsc;
+using namespace ssvsc::Tests;
+
+namespace
+{
+	template<typename TW> inline void testNearest(TW& mWorld)
+	{
+		using BodyType = Body<TW>;
+		Rng rng{9};
+		fillStatics(mWorld, rng, 800, 900, 90);
+
+		std::vector<NearestHit<TW>> hits, expected;
+		for(auto q(0); q < 500; ++q)
+		{
+			const Vec2f pos(getRandom(rng, -1000, 1000), getRandom(rng, -1000, 1000));
+			const SizeT k(getRandom(rng, 0, 12));
+			const float maxDist{q % 3 == 0 ? float(getRandom(rng, 0, 300)) : ssvu::NumLimits<float>::max()};
+			auto filter([q](const BodyType& mBody){ return q % 2 == 0 || mBody.hasGroup(1); });
+			mWorld.nearest(pos, k, filter, hits, maxDist);
+
+			expected.clear();
+			for(const auto& b : mWorld.getBodies())
+			{
+				if(!isIndexed(mWorld.getSpatial(), b->getShape()) || !filter(*b)) continue;
+
+				const auto dist(std::sqrt(Impl::getDistSquared(b->getShape(), pos)));
+				if(dist <= maxDist) expected.push_back({b.get(), dist});
+			}
+			std::sort(std::begin(expected), std::end(expected), [](const NearestHit<TW>& mA, const NearestHit<TW>& mB)
+			{
+				return mA.distance < mB.distance || (mA.distance == mB.distance && mA.body->getHandle() < mB.body->getHandle());
+			});
+			if(expected.size() > k) expected.resize(k);
+
+			SSVSC_CHECK(hits.size() == expected.size());
+			for(auto i(0u); i < std::min(hits.size(), expected.size()); ++i)
+				SSVSC_CHECK(hits[i].body == expected[i].body && std::abs(hits[i].distance - expected[i].distance) < 1e-3f);
+		}
+	}
+}
+
+int main()
+{
+	setCase("nearest, Grid");			{ World<Grid, Retro> world{40, 40, 64, 20}; testNearest(world); }
+	setCase("nearest, HashGrid");		{ World<HashGrid, Retro> world{40, 40, 64, 20}; testNearest(world); }
+	setCase("nearest, RebuildGrid");	{ World<RebuildGrid, Retro> world{40, 40, 64, 20}; testNearest(world); }
+	setCase("nearest, AABBTree");		{ World<AABBTree, Retro> world; testNearest(world); }
+
+	return getResult();
+}
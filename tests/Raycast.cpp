@@ -0,0 +1,62 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Batched ray queries, serial and threaded, checked against brute force over every body of random scenes
+
+#include <cmath>
+#include <vector>
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "TestUtils.hpp"
+
+using namespace ssvsc;
+using namespace ssvsc::Tests;
+
+namespace
+{
+	template<typename TW> inline void testRaycastBatch(TW& mWorld, SizeT mThreads)
+	{
+		Rng rng{7};
+		mWorld.setThreadCount(mThreads);
+		fillStatics(mWorld, rng, 600, 600, 80);
+
+		std::vector<Ray> rays;
+		for(auto i(0); i < 5000; ++i)
+			rays.push_back({Vec2f(getRandom(rng, -620, 620), getRandom(rng, -620, 620)), Vec2f(getRandom(rng, -10, 10), getRandom(rng, -10, 10)),
+				i % 4 == 0 ? float(getRandom(rng, 10, 400)) : ssvu::NumLimits<float>::max()});
+
+		std::vector<RayHit<TW>> hits;
+		mWorld.raycastBatch(rays, hits);
+
+		const auto& grid(mWorld.getSpatial());
+		for(auto i(0u); i < rays.size(); ++i)
+		{
+			const auto& r(rays[i]);
+			const auto length(std::sqrt(r.dir.x * r.dir.x + r.dir.y * r.dir.y));
+			const Vec2i originIdx{Impl::getGridIdxFromFloored(int(std::floor(r.origin.x / grid.getCellSize()))), Impl::getGridIdxFromFloored(int(std::floor(r.origin.y / grid.getCellSize())))};
+
+			// Rays starting outside the grid hit nothing; ties are broken by handle
+			float best{r.maxDist};
+			Body<TW>* expected{nullptr};
+			if(length != 0 && grid.isIdxValid(originIdx))
+				for(const auto& b : mWorld.getBodies())
+				{
+					float t;
+					if(!isIndexed(grid, b->getShape()) || !Impl::getRayEntry(b->getShape(), r.origin, r.dir / length, t)) continue;
+					if(t < best || (t == best && expected != nullptr && b->getHandle() < expected->getHandle())) { best = t; expected = b.get(); }
+				}
+
+			SSVSC_CHECK(hits[i].body == expected || (hits[i].body != nullptr && expected != nullptr && std::abs(hits[i].distance - best) < 1e-3f));
+		}
+	}
+}
+
+int main()
+{
+	setCase("raycastBatch, Grid");					{ World<Grid, Retro> world{40, 40, 32, 20}; testRaycastBatch(world, 1); }
+	setCase("raycastBatch, Grid, 4 threads");		{ World<Grid, Retro> world{40, 40, 32, 20}; testRaycastBatch(world, 4); }
+	setCase("raycastBatch, HashGrid");				{ World<HashGrid, Retro> world{40, 40, 32, 20}; testRaycastBatch(world, 1); }
+	setCase("raycastBatch, RebuildGrid, 3 threads");	{ World<RebuildGrid, Retro> world{40, 40, 32, 20}; testRaycastBatch(world, 3); }
+
+	return getResult();
+}
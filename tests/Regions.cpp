@@ -0,0 +1,57 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Region queries and `World::forEachOverlapping`, with and without a group filter, checked against brute force over every body of random scenes
+
+#include <set>
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "TestUtils.hpp"
+
+using namespace ssvsc;
+using namespace ssvsc::Tests;
+
+namespace
+{
+	template<typename TW> inline void testRegion(TW& mWorld)
+	{
+		using BodyType = Body<TW>;
+		Rng rng{5};
+		fillStatics(mWorld, rng, 500, 600, 120);
+
+		for(auto q(0); q < 300; ++q)
+		{
+			const AABB region{Vec2i{getRandom(rng, -700, 700), getRandom(rng, -700, 700)}, Vec2i{getRandom(rng, 0, 200), getRandom(rng, 0, 200)}};
+			GroupBitset groups;
+			groups[1] = true;
+			groups[2] = q % 2 == 0;
+
+			std::multiset<BodyType*> all, byGroup, query, expectedAll, expectedByGroup;
+			for(const auto& b : mWorld.getBodies())
+			{
+				if(!b->getShape().isOverlapping(region)) continue;
+				expectedAll.insert(b.get());
+				if(b->hasAnyGroup(groups)) expectedByGroup.insert(b.get());
+			}
+
+			mWorld.forEachOverlapping(region, [&all](BodyType& mBody){ all.insert(&mBody); });
+			mWorld.forEachOverlapping(region, groups, [&byGroup](BodyType& mBody){ byGroup.insert(&mBody); });
+			auto regionQuery(mWorld.template getQuery<QueryType::Region>(region));
+			while(auto* b = regionQuery.next()) query.insert(b);
+
+			SSVSC_CHECK(all == expectedAll);
+			SSVSC_CHECK(byGroup == expectedByGroup);
+			SSVSC_CHECK(query == expectedAll);
+		}
+	}
+}
+
+int main()
+{
+	setCase("region, Grid");		{ World<Grid, Retro> world{60, 60, 32, 30}; testRegion(world); }
+	setCase("region, HashGrid");	{ World<HashGrid, Retro> world{60, 60, 32, 30}; testRegion(world); }
+	setCase("region, RebuildGrid");	{ World<RebuildGrid, Retro> world{60, 60, 32, 30}; testRegion(world); }
+	setCase("region, AABBTree");	{ World<AABBTree, Retro> world; testRegion(world); }
+
+	return getResult();
+}
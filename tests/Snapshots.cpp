@@ -0,0 +1,143 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// A snapshot/restore round trip in the middle of an overlap does not change the contact events that follow it, including the contacts with
+// the proxies of a `StaticLevel`, which are not part of snapshots; a snapshot listing a free handle twice is rejected, and the handles of the
+// bodies recreated before the rejection are not handed out again
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "TestUtils.hpp"
+
+using namespace ssvsc;
+using namespace ssvsc::Tests;
+
+namespace
+{
+	using W = World<Grid, Retro>;
+	enum class RoundTrip { None, SameWorld, NewWorld };
+
+	inline void watch(Body<W>& mBody, std::string& mEvents)
+	{
+		// Other bodies are told apart by kind: 'p' for a level proxy, 'n' for a destroyed body, 'x' otherwise
+		auto log([&mEvents](char mEvent, const ContactInfo<W>& mInfo)
+		{
+			mEvents += mEvent;
+			mEvents += mInfo.body == nullptr ? 'n' : mInfo.body->isProxy() ? 'p' : 'x';
+		});
+
+		mBody.onContactBegin += [log](const ContactInfo<W>& mInfo){ log('b', mInfo); };
+		mBody.onContactStay += [log](const ContactInfo<W>& mInfo){ log('s', mInfo); };
+		mBody.onContactEnd += [log](const ContactInfo<W>& mInfo){ log('e', mInfo); };
+	}
+
+	// `m` overlaps a level entry and a static body for three frames, then moves away; the round trip happens after the second frame
+	inline std::string getEvents(const StaticLevel& mLevel, RoundTrip mRoundTrip)
+	{
+		UPtr<W> world{ssvu::makeUPtr<W>(40, 40, 32, 20)};
+		world->setStaticLevel(&mLevel);
+		world->setContactSettings({true, true, false});
+		std::string events;
+
+		// Bodies join the spatial structure during their first step, so the static body is created first
+		auto& s(world->create({40, 10}, {40, 40}, true));
+		auto& m(world->create({10, 10}, {40, 40}, false));
+		s.addGroups(0);
+		m.addGroups(1);
+		m.addGroupsToCheck(0);
+		m.setResolve(false);
+		watch(m, events);
+
+		for(auto f(0); f < 5; ++f)
+		{
+			if(f == 2 && mRoundTrip != RoundTrip::None)
+			{
+				std::vector<char> snapshot;
+				world->snapshot(snapshot);
+
+				if(mRoundTrip == RoundTrip::NewWorld)
+				{
+					world = ssvu::makeUPtr<W>(40, 40, 32, 20);
+					world->setStaticLevel(&mLevel);
+					world->setContactSettings({true, true, false});
+				}
+				world->restore(snapshot.data(), snapshot.size(), [&events](Body<W>& mBody){ if(!mBody.isStatic()) watch(mBody, events); });
+				events += '*';
+			}
+
+			if(f == 3) for(const auto& b : world->getBodies()) if(!b->isStatic()) b->setPosition({400, 400});
+			world->update(1.f);
+			events += '|';
+		}
+
+		SSVSC_CHECK(world->getContactCount() == 0);
+		world->setStaticLevel(nullptr);
+		return events;
+	}
+
+	// Handles 0 and 1 are free in the snapshot, and 2 and 3 in the world it is restored to; the snapshot's second free handle is made a copy
+	// of the first, after the header (24 bytes), the two body ids (12 bytes each), the handle table (8 + 4 * 4 bytes) and the free count
+	inline bool rejectsDuplicateFreeHandles()
+	{
+		W source{40, 40, 32, 20}, target{40, 40, 32, 20};
+		Body<W>* sourceBodies[4];
+		Body<W>* targetBodies[4];
+		for(auto i(0); i < 4; ++i)
+		{
+			sourceBodies[i] = &source.create({10 + i * 50, 10}, {20, 20}, false);
+			targetBodies[i] = &target.create({10 + i * 50, 10}, {20, 20}, false);
+		}
+		source.update(1.f);
+		target.update(1.f);
+		for(auto i(0); i < 2; ++i) { sourceBodies[i]->destroy(); targetBodies[i + 2]->destroy(); }
+		source.update(1.f);
+		target.update(1.f);
+
+		std::vector<char> snapshot;
+		source.snapshot(snapshot);
+		std::memcpy(snapshot.data() + 80, snapshot.data() + 72, sizeof(std::uint64_t));
+
+		auto rejected(false);
+		try { target.restore(snapshot); } catch(const std::runtime_error&) { rejected = true; }
+
+		for(auto i(0); i < 4; ++i) target.create({10 + i * 50, 100}, {20, 20}, false);
+		target.update(1.f);
+
+		std::vector<BodyHandle> handles;
+		for(const auto& b : target.getBodies()) handles.emplace_back(b->getHandle());
+		std::sort(std::begin(handles), std::end(handles));
+		return rejected && handles.size() == 6 && std::adjacent_find(std::begin(handles), std::end(handles)) == std::end(handles);
+	}
+}
+
+int main()
+{
+	GroupBitset groups;
+	groups[0] = true;
+	const std::vector<StaticLevelBody> bodies{{AABB{Vec2i{0, 20}, Vec2i{40, 40}}, groups, {}}};
+
+	std::vector<char> blob;
+	StaticLevel::bake(blob, 40, 40, 32, 20, bodies);
+	const LevelData data{blob};
+	const StaticLevel level{data.data, data.size};
+
+	setCase("no round trip");
+	SSVSC_CHECK(getEvents(level, RoundTrip::None) == "bxbp|sxsp|sxsp|epex||");
+
+	setCase("same world");
+	SSVSC_CHECK(getEvents(level, RoundTrip::SameWorld) == "bxbp|sxsp|*sxsp|epex||");
+
+	setCase("new world");
+	SSVSC_CHECK(getEvents(level, RoundTrip::NewWorld) == "bxbp|sxsp|*sxsp|epex||");
+
+	setCase("duplicate free handle");
+	SSVSC_CHECK(rejectsDuplicateFreeHandles());
+
+	return getResult();
+}
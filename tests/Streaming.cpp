@@ -0,0 +1,73 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// `ChunkStreamer` freezes every live body of an evicted chunk exactly once: bodies destroyed since the last world update (including the ones
+// frozen by an earlier call during the same frame) are neither frozen nor brought back by thawing
+
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "TestUtils.hpp"
+
+using namespace ssvsc;
+using namespace ssvsc::Tests;
+
+namespace
+{
+	using W = World<ChunkedGrid, Retro>;
+
+	// Pages are 256 units wide: the bodies are in chunk (0, 0), and the far point of interest is 8 chunks away from it
+	const Vec2i near{0, 0}, far{2048, 0};
+
+	inline SizeT getLiveCount(const W& mWorld)
+	{
+		SizeT result{0};
+		for(const auto& b : mWorld.getBodies()) if(b->isAlive()) ++result;
+		return result;
+	}
+
+	// Creates three bodies, optionally destroys one, then streams them out (`mEvictions` times in the same frame) and back in
+	inline SizeT getThawedCount(bool mDestroyOne, int mEvictions)
+	{
+		W world{32, 8};
+		ChunkStreamer<W> streamer{world, 1, 2};
+
+		Body<W>* bodies[3];
+		for(auto i(0); i < 3; ++i) bodies[i] = &world.create({20 + i * 40, 20}, {20, 20}, false);
+		world.update(1.f);
+		SSVSC_CHECK(getLiveCount(world) == 3);
+
+		if(mDestroyOne) bodies[1]->destroy();
+
+		SizeT frozen{0};
+		for(auto i(0); i < mEvictions; ++i) streamer.update({far}, [&frozen](Body<W>&){ ++frozen; }, [](Body<W>&){ });
+		SSVSC_CHECK(frozen == (mDestroyOne ? 2u : 3u));
+		SSVSC_CHECK(streamer.isFrozen(streamer.getChunk(near)));
+		SSVSC_CHECK(getLiveCount(world) == 0);
+
+		world.update(1.f);
+		SSVSC_CHECK(world.getBodies().size() == 0);
+
+		SizeT thawed{0};
+		streamer.update({near}, [](Body<W>&){ }, [&thawed](Body<W>&){ ++thawed; });
+		world.update(1.f);
+		SSVSC_CHECK(getLiveCount(world) == thawed);
+		return thawed;
+	}
+}
+
+int main()
+{
+	setCase("stream out and in");
+	SSVSC_CHECK(getThawedCount(false, 1) == 3);
+
+	setCase("destroy, then stream out and in");
+	SSVSC_CHECK(getThawedCount(true, 1) == 2);
+
+	setCase("stream out twice in one frame");
+	SSVSC_CHECK(getThawedCount(false, 2) == 3);
+
+	setCase("destroy, then stream out twice in one frame");
+	SSVSC_CHECK(getThawedCount(true, 2) == 2);
+
+	return getResult();
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef SSVSC_TESTS_TESTUTILS
+#define SSVSC_TESTS_TESTUTILS
+
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <SSVSCollision/SSVSCollision.hpp>
+
+// Failed checks are reported with their location and the current test case, and make `getResult` return a failure
+#define SSVSC_CHECK(mExpr) ::ssvsc::Tests::check(static_cast<bool>(mExpr), #mExpr, __FILE__, __LINE__)
+
+namespace ssvsc
+{
+	namespace Tests
+	{
+		using Rng = std::mt19937;
+
+		inline int& getFailureCount() noexcept			{ static int count{0}; return count; }
+		inline const char*& getCaseName() noexcept		{ static const char* name{""}; return name; }
+		inline void setCase(const char* mName) noexcept	{ getCaseName() = mName; }
+
+		inline void check(bool mPassed, const char* mExpr, const char* mFile, int mLine)
+		{
+			if(mPassed) return;
+			++getFailureCount();
+			std::fprintf(stderr, "%s:%d: [%s] check failed: %s\n", mFile, mLine, getCaseName(), mExpr);
+		}
+
+		inline int getResult()
+		{
+			if(getFailureCount() == 0) return EXIT_SUCCESS;
+			std::fprintf(stderr, "%d check(s) failed\n", getFailureCount());
+			return EXIT_FAILURE;
+		}
+
+		inline int getRandom(Rng& mRng, int mMin, int mMax) { return std::uniform_int_distribution<int>{mMin, mMax}(mRng); }
+
+		// Creates `mCount` random static bodies, spread over the first three groups, in a square of half side `mHalfSide` centered on the origin
+		template<typename TW> inline void fillStatics(TW& mWorld, Rng& mRng, SizeT mCount, int mHalfSide, int mMaxSize)
+		{
+			for(auto i(0u); i < mCount; ++i)
+			{
+				auto& b(mWorld.create({getRandom(mRng, -mHalfSide, mHalfSide), getRandom(mRng, -mHalfSide, mHalfSide)}, {getRandom(mRng, 2, mMaxSize), getRandom(mRng, 2, mMaxSize)}, true));
+				b.addGroups(i % 3);
+			}
+
+			// Static bodies join the spatial structure during their first step
+			mWorld.update(1.f);
+		}
+
+		// Grids ignore the bodies they could not bin; the AABB tree has no bounds
+		template<typename TS> inline bool isIndexed(const TS& mSpatial, const AABB& mShape)
+		{
+			return mSpatial.isIdxValid(mSpatial.getIdx(mShape.getLeft()), mSpatial.getIdx(mShape.getTop()), mSpatial.getIdx(mShape.getRight()), mSpatial.getIdx(mShape.getBottom()));
+		}
+		template<typename TW> inline bool isIndexed(const AABBTree<TW>&, const AABB&) { return true; }
+
+		// Copy of a baked `StaticLevel`, aligned like a mapped file
+		struct LevelData
+		{
+			std::vector<char> storage;
+			const char* data;
+			SizeT size;
+
+			inline LevelData(const std::vector<char>& mBlob) : storage(mBlob.size() + Impl::staticLevelAlignment), size{mBlob.size()}
+			{
+				const auto address(reinterpret_cast<std::uintptr_t>(storage.data()));
+				const auto offset(Impl::alignStaticLevelOffset(address) - address);
+				std::memcpy(storage.data() + offset, mBlob.data(), size);
+				data = storage.data() + offset;
+			}
+		};
+	}
+}
+
+#endif
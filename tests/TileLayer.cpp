@@ -0,0 +1,232 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Merged bodies of a `TileLayer` cover exactly its solid tiles, with as many rectangles as the greedy merge makes; ray and orthogonal casts
+// are checked against brute force over every solid tile of random bitmaps; `clear` skips merged bodies destroyed (and reused) in the meantime
+
+#include <cmath>
+#include <vector>
+#include <SSVSCollision/SSVSCollision.hpp>
+#include "TestUtils.hpp"
+
+using namespace ssvsc;
+using namespace ssvsc::Tests;
+
+namespace
+{
+	using W = World<Grid, Retro>;
+	using Layer = TileLayer<W>;
+	using Bitmap = std::vector<std::vector<bool>>;
+
+	const Vec2i origin{-160, -96};
+	constexpr int tileSize{16}, cols{20}, rows{12};
+
+	inline Bitmap getRandomBitmap(Rng& mRng, int mDensity)
+	{
+		Bitmap result(rows, std::vector<bool>(cols));
+		for(auto& r : result) for(int iX{0}; iX < cols; ++iX) r[iX] = getRandom(mRng, 0, 99) < mDensity;
+		return result;
+	}
+
+	// Reference merge: rectangles as wide as possible, then as tall as possible, in row-major order of their top-left tile
+	inline SizeT getRectangleCount(const Bitmap& mBitmap)
+	{
+		Bitmap merged(rows, std::vector<bool>(cols));
+		auto isFree([&](int mX, int mY){ return mBitmap[mY][mX] && !merged[mY][mX]; });
+
+		SizeT result{0};
+		for(int iY{0}; iY < rows; ++iY)
+			for(int iX{0}; iX < cols; ++iX)
+			{
+				if(!isFree(iX, iY)) continue;
+
+				int width{1}, height{1};
+				while(iX + width < cols && isFree(iX + width, iY)) ++width;
+				while(iY + height < rows)
+				{
+					bool rowFree{true};
+					for(int x{iX}; x < iX + width; ++x) rowFree = rowFree && isFree(x, iY + height);
+					if(!rowFree) break;
+					++height;
+				}
+
+				for(int y{iY}; y < iY + height; ++y) for(int x{iX}; x < iX + width; ++x) merged[y][x] = true;
+				++result;
+			}
+
+		return result;
+	}
+
+	inline void checkMerge(const Bitmap& mBitmap)
+	{
+		W world{40, 40, 32, 20};
+		Layer layer{world, origin, tileSize, cols, rows};
+		layer.fill([&mBitmap](int mX, int mY){ return mBitmap[mY][mX]; });
+		layer.rebuild();
+
+		std::vector<std::vector<int>> coverage(rows, std::vector<int>(cols, 0));
+		SizeT count{0}, outside{0};
+		layer.forEachBody([&](Body<W>& mBody)
+		{
+			++count;
+			const auto& s(mBody.getShape());
+			for(int iY{(s.getTop() - origin.y) / tileSize}; iY < (s.getBottom() - origin.y) / tileSize; ++iY)
+				for(int iX{(s.getLeft() - origin.x) / tileSize}; iX < (s.getRight() - origin.x) / tileSize; ++iX)
+					if(layer.isIdxValid(iX, iY)) ++coverage[iY][iX]; else ++outside;
+		});
+
+		SSVSC_CHECK(count == getRectangleCount(mBitmap));
+		SSVSC_CHECK(outside == 0);
+		for(int iY{0}; iY < rows; ++iY)
+			for(int iX{0}; iX < cols; ++iX) SSVSC_CHECK(coverage[iY][iX] == (mBitmap[iY][iX] ? 1 : 0));
+	}
+
+	// Slab test against the half-open tile at `mX`, `mY`: returns the entry distance (0 for rays starting inside) and normal if the ray hits it
+	inline bool getTileEntry(const Ray& mRay, const Vec2f& mDir, int mX, int mY, float& mT, Vec2i& mNormal)
+	{
+		const float lefts[2]{float(origin.x + mX * tileSize), float(origin.y + mY * tileSize)};
+		const float origins[2]{mRay.origin.x, mRay.origin.y}, dirs[2]{mDir.x, mDir.y};
+
+		float enter{-ssvu::NumLimits<float>::max()}, exit{ssvu::NumLimits<float>::max()};
+		int enterAxis{0};
+		for(auto a(0); a < 2; ++a)
+		{
+			const float left{lefts[a]}, right{lefts[a] + tileSize};
+			if(dirs[a] == 0)
+			{
+				if(origins[a] < left || origins[a] >= right) return false;
+				continue;
+			}
+
+			const float t0{((dirs[a] > 0 ? left : right) - origins[a]) / dirs[a]}, t1{((dirs[a] > 0 ? right : left) - origins[a]) / dirs[a]};
+			if(t0 > enter) { enter = t0; enterAxis = a; }
+			exit = std::min(exit, t1);
+		}
+
+		if(enter >= exit || exit <= 0) return false;
+		mT = std::max(enter, 0.f);
+		if(enter <= 0) mNormal = {0, 0};
+		else if(enterAxis == 0) mNormal = {dirs[0] > 0 ? -1 : 1, 0};
+		else mNormal = {0, dirs[1] > 0 ? -1 : 1};
+		return mT <= mRay.maxDist;
+	}
+
+	inline void checkRay(const Layer& mLayer, const TileHit& mHit, const Ray& mRay)
+	{
+		const auto length(std::sqrt(mRay.dir.x * mRay.dir.x + mRay.dir.y * mRay.dir.y));
+		const Vec2f dir{mRay.dir / length};
+
+		bool expected{false};
+		float best{0};
+		Vec2i tile, normal;
+		for(int iY{0}; iY < rows; ++iY)
+			for(int iX{0}; iX < cols; ++iX)
+			{
+				float t;
+				Vec2i n;
+				if(!mLayer.isSolid(iX, iY) || !getTileEntry(mRay, dir, iX, iY, t, n) || (expected && t >= best)) continue;
+				expected = true;
+				best = t;
+				tile = {iX, iY};
+				normal = n;
+			}
+
+		SSVSC_CHECK(mHit.hit == expected);
+		if(!mHit.hit || !expected) return;
+
+		// Rays grazing a corner may enter two tiles at the same distance: only the distance has to match then
+		SSVSC_CHECK(std::abs(mHit.distance - best) < 1e-3f);
+		if(std::abs(mHit.distance - best) < 1e-3f && mHit.tile != tile) return;
+		SSVSC_CHECK(mHit.tile == tile);
+		SSVSC_CHECK(mHit.normal == normal);
+	}
+
+	inline void checkCasts(const Bitmap& mBitmap, Rng& mRng)
+	{
+		W world{40, 40, 32, 20};
+		Layer layer{world, origin, tileSize, cols, rows};
+		layer.fill([&mBitmap](int mX, int mY){ return mBitmap[mY][mX]; });
+
+		// Origins are off the tile edges (so that rays rarely graze corners), and spread both inside and outside of the layer; every fourth ray
+		// starts near the middle of a tile
+		auto getOrigin([&](int mQuery)
+		{
+			if(mQuery % 4 == 0) return Vec2f(origin.x + getRandom(mRng, 0, cols - 1) * tileSize + 8.3f, origin.y + getRandom(mRng, 0, rows - 1) * tileSize + 8.7f);
+			return Vec2f(getRandom(mRng, -2500, 2500) / 10.f + 0.05f, getRandom(mRng, -1500, 1500) / 10.f + 0.05f);
+		});
+		auto getMaxDist([&](int mQuery){ return mQuery % 3 == 0 ? float(getRandom(mRng, 0, 200)) + 0.5f : ssvu::NumLimits<float>::max(); });
+
+		for(auto q(0); q < 2000; ++q)
+		{
+			Vec2f dir(getRandom(mRng, -100, 100) / 10.f, getRandom(mRng, -100, 100) / 10.f);
+			if(dir.x == 0 && dir.y == 0) dir.x = 1;
+
+			const Ray ray{getOrigin(q), dir, getMaxDist(q)};
+			checkRay(layer, layer.raycast(ray), ray);
+		}
+
+		const Vec2i dirs[4]{{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+		for(auto q(0); q < 2000; ++q)
+		{
+			const Ray ray{getOrigin(q), Vec2f(dirs[q % 4]), getMaxDist(q)};
+			checkRay(layer, layer.castOrtho(ray.origin, dirs[q % 4], ray.maxDist), ray);
+		}
+	}
+
+	// The game destroys a merged body, and its handle is reused by a new body before the layer is cleared; the column on top of the floor
+	// takes the floor tile under it, splitting the floor in two
+	inline void checkClearSkipsReused()
+	{
+		W world{40, 40, 32, 20};
+		Layer layer{world, origin, tileSize, cols, rows};
+		layer.fill([](int mX, int mY){ return mY == rows - 1 || (mX == 3 && mY > 5); });
+		layer.rebuild();
+		world.update(1.f);
+
+		SizeT count{0};
+		Body<W>* first{nullptr};
+		layer.forEachBody([&](Body<W>& mBody){ if(first == nullptr) first = &mBody; ++count; });
+		SSVSC_CHECK(count == 3);
+		if(first == nullptr) return;
+
+		const auto handle(first->getHandle());
+		first->destroy();
+		world.update(1.f);
+
+		auto& other(world.create({400, 400}, {20, 20}, false));
+		SSVSC_CHECK(other.getHandle() == handle);
+
+		count = 0;
+		layer.forEachBody([&count](Body<W>&){ ++count; });
+		SSVSC_CHECK(count == 2);
+
+		layer.clear();
+		world.update(1.f);
+		SSVSC_CHECK(world.getBodies().size() == 1);
+		SSVSC_CHECK(other.isAlive());
+	}
+}
+
+int main()
+{
+	Rng rng{11};
+
+	setCase("merge, empty");	checkMerge(Bitmap(rows, std::vector<bool>(cols, false)));
+	setCase("merge, full");		checkMerge(Bitmap(rows, std::vector<bool>(cols, true)));
+	setCase("merge, random");	for(auto d : {10, 50, 90}) for(auto i(0); i < 20; ++i) checkMerge(getRandomBitmap(rng, d));
+
+	setCase("merge, counts");
+	{
+		Bitmap checkerboard(rows, std::vector<bool>(cols));
+		for(int iY{0}; iY < rows; ++iY) for(int iX{0}; iX < cols; ++iX) checkerboard[iY][iX] = (iX + iY) % 2 == 0;
+		SSVSC_CHECK(getRectangleCount(checkerboard) == SizeT(cols * rows / 2));
+		SSVSC_CHECK(getRectangleCount(Bitmap(rows, std::vector<bool>(cols, true))) == 1);
+		checkMerge(checkerboard);
+	}
+
+	setCase("casts, random");	for(auto d : {5, 20, 60}) checkCasts(getRandomBitmap(rng, d), rng);
+	setCase("clear, reused handle");	checkClearSkipsReused();
+
+	return getResult();
+}